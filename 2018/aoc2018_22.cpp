@@ -3,6 +3,30 @@
 #include <vector>
 #include <limits>
 #include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <bit>
+#include <memory>
+#include <fstream>
+#include <string>
+#include <array>
+#include <unordered_map>
+#include <string_view>
+#include <chrono>
+#include <thread>
+#include <barrier>
+#include <numeric>
+#include <queue>
+#include <tuple>
+#include <utility>
+
+#include <common/graph.h>
+#include <common/arena.h>
+#include <common/instrument.h>
+
+namespace aoc2018_22
+{
 
 struct pt
 {
@@ -15,41 +39,233 @@ constexpr int rocky {0};
 constexpr int wet {1};
 constexpr int narrow {2};
 
-constexpr int stride = 24;
+constexpr int erosion_modulo {20183};
 
-struct cave_system
+enum class storage { levels, types };
+
+// erosion levels are computed a 64x64 tile at a time, row by row, the first
+// time a region in the tile is looked at. a level needs the levels to its left
+// and above so the tiles above and to the left are filled first, which keeps
+// each row of tiles a prefix of the cave. every tile keeps its last row and
+// column for its neighbours, and the rest is either the 16 bit erosion levels
+// or, all the search needs, the region types packed 2 bits to a region.
+//
+class erosion_store
 {
-private:
-    std::vector<int> sys_;
-    const pt target_;
-    const int depth_;
+    static constexpr int tile_bits = 6;
+    static constexpr int tile_size = 1 << tile_bits;
+    static constexpr int tile_mask = tile_size - 1;
+    static constexpr int types_per_word = 32;
+    struct tile_t
+    {
+        std::array<std::uint16_t, tile_size> right_;
+        std::array<std::uint16_t, tile_size> bottom_;
+        std::vector<std::uint16_t> levels_; // storage::levels
+        std::vector<std::uint64_t> types_;  // storage::types, 2 words to a row
+    };
+    std::vector<std::vector<std::unique_ptr<tile_t>>> tiles_; // [tile y][tile x]
+    const pt      target_;
+    const int     depth_;
+    const storage mode_;
 
-    int erosion_level(pt const& p)
+    std::unique_ptr<tile_t> make_tile(size_t tx, size_t ty, tile_t const* left, tile_t const* up) const
     {
-        int el = sys_[p.x_ + p.y_ * stride];
-        if( el == -1)
+        auto t = std::make_unique<tile_t>();
+        if( mode_ == storage::levels)
+            t->levels_.resize(tile_size * tile_size);
+        else
+            t->types_.resize(tile_size * tile_size / types_per_word);
+        std::array<std::uint16_t, tile_size> prev {};
+        std::array<std::uint16_t, tile_size> cur;
+        if( up)
+            prev = up->bottom_;
+        std::int64_t x0 = tx * tile_size;
+        std::int64_t y0 = ty * tile_size;
+        for( int r = 0; r < tile_size; ++r)
         {
-            int gi {0};
-            if( p.x_ == 0)
-                gi = p.y_ * 48271;
+            std::int64_t y = y0 + r;
+            std::uint32_t el_left = left ? left->right_[r] : 0;
+            for( int c = 0; c < tile_size; ++c)
+            {
+                std::int64_t x = x0 + c;
+                std::int64_t gi;
+                if( x == 0)
+                    gi = y * 48271;
+                else
+                if( y == 0)
+                    gi = x * 16807;
+                else
+                if( x == target_.x_ && y == target_.y_)
+                    gi = 0;
+                else
+                    gi = std::int64_t(el_left) * prev[c];
+                el_left = (gi + depth_) % erosion_modulo;
+                cur[c] = el_left;
+            }
+            if( mode_ == storage::levels)
+                std::copy(cur.begin(), cur.end(), t->levels_.begin() + r * tile_size);
             else
-            if(p.y_ == 0)
-                gi = p.x_ * 16807;
+                for( int c = 0; c < tile_size; ++c)
+                    t->types_[(r * tile_size + c) / types_per_word] |= std::uint64_t(cur[c] % 3) << (c % types_per_word * 2);
+            t->right_[r] = cur[tile_size - 1];
+            prev = cur;
+        }
+        t->bottom_ = prev;
+        return t;
+    }
+    void fill(size_t tx, size_t ty)
+    {
+        AOC_COUNT("erosion tiles", 1);
+        tiles_[ty].push_back(make_tile(tx, ty, tx > 0 ? tiles_[ty][tx - 1].get() : nullptr,
+                                               ty > 0 ? tiles_[ty - 1][tx].get() : nullptr));
+    }
+    tile_t const& tile(pt const& p)
+    {
+        auto ty = size_t(p.y_ >> tile_bits);
+        auto tx = size_t(p.x_ >> tile_bits);
+        if( tiles_.size() <= ty || tiles_[ty].size() <= tx)
+        {
+            if( tiles_.size() <= ty)
+                tiles_.resize(ty + 1);
+            for( size_t y = 0; y <= ty; ++y)
+                while( tiles_[y].size() <= tx)
+                    fill(tiles_[y].size(), y);
+        }
+        return *tiles_[ty][tx];
+    }
+public:
+    erosion_store(pt const& t, int d, storage m) : target_{t}, depth_{d}, mode_{m}
+    {}
+    // fill every tile covering [0, p.x_] x [0, p.y_]. a tile depends only on
+    // tiles on the anti-diagonal before its own, so each thread takes every
+    // n'th tile of a diagonal and they all wait for each other at the end of
+    // it. new tiles go into 'grid' and join their rows when all are done.
+    //
+    void fill(pt const& p, unsigned threads)
+    {
+        AOC_TIMED("erosion fill");
+        size_t ntx = size_t(p.x_ >> tile_bits) + 1;
+        size_t nty = size_t(p.y_ >> tile_bits) + 1;
+        if( tiles_.size() < nty)
+            tiles_.resize(nty);
+        std::vector<std::unique_ptr<tile_t>> grid(ntx * nty);
+        auto at = [&](size_t tx, size_t ty) -> tile_t const*
+        {
+            if( tx < tiles_[ty].size())
+                return tiles_[ty][tx].get();
+            return grid[ty * ntx + tx].get();
+        };
+        threads = std::max(threads, 1u);
+        auto diagonal = [&](size_t k, unsigned id)
+        {
+            size_t ty_first = k < ntx ? 0 : k - ntx + 1;
+            size_t ty_last  = std::min(k, nty - 1);
+            for( size_t ty = ty_first + id; ty <= ty_last; ty += threads)
+            {
+                auto tx = k - ty;
+                if( tx >= tiles_[ty].size())
+                    grid[ty * ntx + tx] = make_tile(tx, ty, tx > 0 ? at(tx - 1, ty) : nullptr,
+                                                            ty > 0 ? at(tx, ty - 1) : nullptr);
+            }
+        };
+        auto diagonals = ntx + nty - 1;
+        if( threads == 1)
+            for( size_t k = 0; k < diagonals; ++k)
+                diagonal(k, 0);
+        else
+        {
+            std::barrier sync(threads);
+            std::vector<std::jthread> pool;
+            for( unsigned id = 0; id < threads; ++id)
+                pool.emplace_back([&, id]
+                    {
+                        for( size_t k = 0; k < diagonals; ++k)
+                        {
+                            diagonal(k, id);
+                            sync.arrive_and_wait();
+                        }
+                    });
+        }
+        for( size_t ty = 0; ty < nty; ++ty)
+        {
+            // a row may already run past ntx, lazily filled by tile().
+            AOC_COUNT("erosion tiles", ntx > tiles_[ty].size() ? ntx - tiles_[ty].size() : 0);
+            for( auto tx = tiles_[ty].size(); tx < ntx; ++tx)
+                tiles_[ty].push_back(std::move(grid[ty * ntx + tx]));
+        }
+    }
+    int type(pt const& p)
+    {
+        auto& t = tile(p);
+        auto  o = (p.y_ & tile_mask) * tile_size + (p.x_ & tile_mask);
+        if( mode_ == storage::levels)
+            return t.levels_[o] % 3;
+        return (t.types_[o / types_per_word] >> (o % types_per_word * 2)) & 3;
+    }
+    // sum of the types of regions [0, w) in row y, which must have been
+    // filled already.
+    //
+    int risk(int y, int w) const
+    {
+        int rv {0};
+        auto& row = tiles_[y >> tile_bits];
+        auto  r   = y & tile_mask;
+        for( int x = 0; x < w; x += tile_size)
+        {
+            auto& t = *row[x >> tile_bits];
+            auto  n = std::min(tile_size, w - x);
+            if( mode_ == storage::levels)
+            {
+                auto b = t.levels_.begin() + r * tile_size;
+                for( int c = 0; c < n; ++c)
+                    rv += b[c] % 3;
+            }
             else
-            if( p != target_)
-                gi = erosion_level({p.x_ - 1, p.y_}) *
-                        erosion_level({p.x_, p.y_ - 1});
-            el = (gi + depth_) % 20183;
-            sys_[p.x_ + p.y_ * stride] = el;
+            {
+                // a type is 2 bits, so count the low and high bits separately
+                for( int c = 0; c < n; c += types_per_word)
+                {
+                    auto bits = t.types_[(r * tile_size + c) / types_per_word];
+                    auto m = std::min(types_per_word, n - c);
+                    if( m < types_per_word)
+                        bits &= (std::uint64_t{1} << (m * 2)) - 1;
+                    rv += std::popcount(bits & 0x5555555555555555) + 2 * std::popcount(bits & 0xaaaaaaaaaaaaaaaa);
+                }
+            }
         }
-        return el;
+        return rv;
+    }
+    size_t tiles() const
+    {
+        size_t n {0};
+        for(auto& row : tiles_)
+            n += row.size();
+        return n;
     }
+};
+
+struct cave_system
+{
+private:
+    erosion_store sys_;
 public:
-    cave_system(pt const& t, int d) : target_ {t}, depth_{d}, sys_(stride * 1024, -1)
+    cave_system(pt const& t, int d, storage m = storage::types) : sys_{t, d, m}
     {}
     int type(pt const& p)
     {
-        return erosion_level(p) % 3;
+        return sys_.type(p);
+    }
+    void fill(pt const& p, unsigned threads)
+    {
+        sys_.fill(p, threads);
+    }
+    int risk(int y, int w) const
+    {
+        return sys_.risk(y, w);
+    }
+    size_t tiles() const
+    {
+        return sys_.tiles();
     }
 };
 
@@ -68,66 +284,98 @@ void test()
     std::cout << "el { 10, 10 } = " << cs.type({10, 10}) << '\n';
 }
 
-int pt1(pt const& t, int d)
+// the cave is filled by wavefront then each thread sums the risk of a
+// band of rows.
+//
+std::int64_t pt1(pt const& t, int d, storage m, unsigned threads)
 {
-    cave_system cs { t, d};
-    int rv {0};
-    for(int x = 0; x <= t.x_; ++x)
-        for(int y = 0; y <= t.y_; ++y)
-            rv += cs.type({x, y});
-    
-    return rv;
+    cave_system cs { t, d, m};
+    cs.fill(t, threads);
+    threads = std::max(threads, 1u);
+    std::vector<std::int64_t> sums(threads);
+    auto band = [&](unsigned id)
+    {
+        int rows = t.y_ + 1;
+        int y0 = rows * std::int64_t(id) / threads;
+        int y1 = rows * std::int64_t(id + 1) / threads;
+        for( int y = y0; y < y1; ++y)
+            sums[id] += cs.risk(y, t.x_ + 1);
+    };
+    if( threads == 1)
+        band(0);
+    else
+    {
+        std::vector<std::jthread> pool;
+        for( unsigned id = 0; id < threads; ++id)
+            pool.emplace_back(band, id);
+    }
+    return std::reduce(sums.begin(), sums.end());
 }
 
 constexpr int neither {0};
 constexpr int climbing {1};
 constexpr int torch {2};
 
-using vertex_t = int;
-using edge_t  = struct{ int wt_; int to_;};
-using graph_t = std::vector<std::vector<edge_t>>;
+// a vertex is a region and the tool held there, packed so that neither
+// coordinate is limited by the numbering.
+//
+using vertex_t = std::int64_t;
 
 vertex_t vertex_id_from_region_tool(pt p, int tool)
 {
-    return (p.y_ * stride + p.x_) * 3 + tool;
+    return (vertex_t(p.y_) << 34) | (vertex_t(p.x_) << 2) | tool;
 }
 
-void add_vertex(vertex_t id, graph_t& g)
+pt region_from_vertex_id(vertex_t v)
 {
-    while( g.size() <= id)
-        g.push_back({});
+    return { int((v >> 2) & 0xffffffff), int(v >> 34)};
 }
 
-void add_edge(vertex_t from, vertex_t to, int weight, graph_t& g)
+int tool_from_vertex_id(vertex_t v)
 {
-    add_vertex(from, g);
-    add_vertex(to, g);
-    g[from].push_back({weight, to});
+    return int(v & 3);
 }
 
-// a region has three vertices, representing each 'tool',
-// and edges to represent changing between each (7 min).
-// the edge out of each vertex represents crossing this region
-// and entering theh next (1min).
-//
-void install_region( pt p, graph_t& g)
-{
-    auto v_neither  = vertex_id_from_region_tool(p, neither);
-    auto v_climbing = vertex_id_from_region_tool(p, climbing);
-    auto v_torch    = vertex_id_from_region_tool(p, torch);
-    // vertex for each tool
-    add_vertex(v_neither, g);
-    add_vertex(v_climbing, g);
-    add_vertex(v_torch, g);    
-    // tool swaps
-    add_edge(v_neither, v_climbing, 7, g);
-    add_edge(v_neither, v_torch, 7, g);
-    add_edge(v_climbing, v_neither, 7, g);
-    add_edge(v_climbing, v_torch, 7, g);
-    add_edge(v_torch, v_neither, 7, g);
-    add_edge(v_torch, v_climbing, 7, g);
+// the part of the cave covered by a built graph, and the dense numbering
+// of the vertices within it.
+//
+struct cave_rect
+{
+    int width_;
+    int height_;
+    bool contains(pt p) const
+    {
+        return p.x_ >= 0 && p.x_ < width_ && p.y_ >= 0 && p.y_ < height_;
+    }
+    size_t index(vertex_t v) const
+    {
+        auto p = region_from_vertex_id(v);
+        return (size_t(p.y_) * width_ + p.x_) * 3 + tool_from_vertex_id(v);
+    }
+    size_t size() const
+    {
+        return size_t(width_) * height_ * 3;
+    }
+    size_t operator()(vertex_t v) const
+    {
+        return index(v);
+    }
+};
+
+struct explicit_graph
+{
+    cave_rect                           rect_;
+    aoc::adjacency_list<vertex_t, int> adj_;
+};
+
+void add_edge(vertex_t from, vertex_t to, int weight, explicit_graph& g)
+{
+    AOC_COUNT("graph edges", 1);
+    g.adj_.add_edge(g.rect_.index(from), to, weight);
 }
 
+// whether 'tool' may be held in a region of 'type'.
+//
 bool cross_region( int type, int tool)
 {
     switch(type)
@@ -143,100 +391,479 @@ bool cross_region( int type, int tool)
     }
 }
 
-graph_t build_graph (pt const& t, int d)
+// a region has three vertices, representing each 'tool',
+// and edges to represent changing between the two that may be held
+// there (7 min). the edge out of each vertex represents crossing this
+// region and entering the next, which the tool must also suit (1min).
+//
+void install_region( pt p, int type, explicit_graph& g)
+{
+    for( int from = 0; from < 3; ++from)
+        for( int to = 0; to < 3; ++to)
+            if( from != to && cross_region(type, from) && cross_region(type, to))
+                add_edge(vertex_id_from_region_tool(p, from), vertex_id_from_region_tool(p, to), 7, g);
+}
+
+// both searches are confined to the target and a margin beyond it. a route
+// that leaves the rect reaches a region p at least 'margin' past the target
+// in x (or y), and costs at least p.x + p.y to get there and p.x - t.x +
+// |p.y - t.y| to come back, so at least t.x + t.y + 2 * margin in all. a
+// route found within the rect no longer than that is the best there is.
+//
+constexpr int search_margin {16};
+
+cave_rect search_rect(pt const& t, int margin = search_margin)
+{
+    return { t.x_ + margin, t.y_ + margin};
+}
+
+// the least margin that shuts out every route longer than 'dist'.
+//
+int search_margin_for(pt const& t, int dist)
+{
+    return std::max(search_margin, (dist - t.x_ - t.y_ + 1) / 2);
+}
+
+// the graph covers search_rect(t, margin). its edge lists, a small vector for
+// each vertex, come from 'r'.
+//
+explicit_graph build_graph (pt const& t, int d, storage m, unsigned threads, std::pmr::memory_resource* r = std::pmr::get_default_resource(), int margin = search_margin)
 {
-    graph_t g;
+    AOC_TIMED("build_graph");
+    auto rect = search_rect(t, margin);
+    explicit_graph g { rect, aoc::adjacency_list<vertex_t, int>(rect.size(), r)};
+    cave_system cs { t, d, m};
+    cs.fill({g.rect_.width_ - 1, g.rect_.height_ - 1}, threads);
     // install the regions
-    for( int y = 0; y < t.y_ + 16; ++y)
-        for(int x = 0; x < stride; ++x)
-            install_region({x, y}, g);
+    for( int y = 0; y < g.rect_.height_; ++y)
+        for(int x = 0; x < g.rect_.width_; ++x)
+            install_region({x, y}, cs.type({x, y}), g);
     // connect them together
-    cave_system cs { t, d};
-    for( int y = 0; y < t.y_ + 16; ++y)
-        for(int x = 0; x < stride - 1; ++x)
+    for( int y = 0; y < g.rect_.height_; ++y)
+        for(int x = 0; x < g.rect_.width_; ++x)
         {
+            int type = cs.type({x, y});
             for( int tool = 0; tool < 3; ++tool)
             {
-                int type = cs.type({x, y});
                 if( cross_region(type, tool))
                 {
-                    if( x > 0) // left
-                        add_edge(vertex_id_from_region_tool({x, y}, tool), vertex_id_from_region_tool({x - 1, y}, tool), 1, g);
-                    // right
-                    add_edge(vertex_id_from_region_tool({x, y}, tool), vertex_id_from_region_tool({x + 1, y}, tool), 1, g);
-                    if ( y > 0) // up
-                        add_edge(vertex_id_from_region_tool({x, y}, tool), vertex_id_from_region_tool({x, y - 1}, tool), 1, g);
-                    // down
-                    add_edge(vertex_id_from_region_tool({x, y}, tool), vertex_id_from_region_tool({x, y + 1}, tool), 1, g);
+                    for( pt n : { pt{x - 1, y}, pt{x + 1, y}, pt{x, y - 1}, pt{x, y + 1}})
+                        if( g.rect_.contains(n) && cross_region(cs.type(n), tool))
+                            add_edge(vertex_id_from_region_tool({x, y}, tool), vertex_id_from_region_tool(n, tool), 1, g);
                 }
             }
         }
     return g;
 }
 
-void print( graph_t const& g)
+void print( explicit_graph const& g)
 {
-    int v = 0;
-    for(auto& al : g)
+    for( int y = 0; y < g.rect_.height_; ++y)
+        for(int x = 0; x < g.rect_.width_; ++x)
+            for( int tool = 0; tool < 3; ++tool)
+            {
+                auto v = vertex_id_from_region_tool({x, y}, tool);
+                std::cout << "{ " << x << ", " << y << ", " << tool << " } : ";
+                for(auto& e : g.adj_[g.rect_.index(v)])
+                {
+                    auto p = region_from_vertex_id(e.to_);
+                    std::cout << "{ " << p.x_ << ", " << p.y_ << ", " << tool_from_vertex_id(e.to_) << ", " << e.wt_ << " }";
+                }
+                std::cout << '\n';
+            }
+}
+
+// the searches are those of common/graph.h, which see a graph through
+// for_each_edge(g, u, f) and keep distances in a store indexed, for the
+// explicit graph, by the rect.
+//
+template<typename F> void for_each_edge(explicit_graph const& g, vertex_t u, F f)
+{
+    for( auto& e : g.adj_[g.rect_.index(u)])
+        f(e.to_, e.wt_);
+}
+
+using dense_distances  = aoc::dense_distances<int, cave_rect>;
+using sparse_distances = aoc::sparse_distances<vertex_t, int>;
+
+// the cave as an implicit graph. edges are generated from the region types
+// as the search reaches each vertex and nothing is built up front. the cave
+// itself is unbounded, the search kept within bound_ as the explicit graph
+// is, else it wanders the whole disc around the start closer than the target.
+//
+struct cave_graph
+{
+    cave_system& cs_;
+    cave_rect    bound_;
+};
+
+template<typename F> void for_each_edge(cave_graph const& g, vertex_t u, F f)
+{
+    int tool = tool_from_vertex_id(u);
+    pt p = region_from_vertex_id(u);
+    int type = g.cs_.type(p);
+    for( int t = 0; t < 3; ++t)
+        if( t != tool && cross_region(type, t))
+            f(vertex_id_from_region_tool(p, t), 7);
+    if( !cross_region(type, tool))
+        return;
+    for( pt n : { pt{p.x_ - 1, p.y_}, pt{p.x_ + 1, p.y_}, pt{p.x_, p.y_ - 1}, pt{p.x_, p.y_ + 1}})
+        if( g.bound_.contains(n) && cross_region(g.cs_.type(n), tool))
+            f(vertex_id_from_region_tool(n, tool), 1);
+}
+
+// every region between here and the target costs at least one move, and
+// arriving without the torch costs a swap. consistent as a move changes
+// this by at most 1 and a swap by at most 7.
+//
+struct rescue_heuristic
+{
+    pt target_;
+    int operator()(vertex_t v) const
     {
-        std::cout << v << " : ";
-        for(auto& e : al)
-        {
-            std::cout << "{ " << e.to_ << ", " << e.wt_ << " }";
-        }
-        std::cout << '\n';
-        ++v;
+        auto p = region_from_vertex_id(v);
+        return std::abs(p.x_ - target_.x_) + std::abs(p.y_ - target_.y_) +
+               (tool_from_vertex_id(v) == torch ? 0 : 7);
     }
+};
+
+using search_result = aoc::search_result<int, vertex_t>;
+
+// edge weights are only 1 (move) or 7 (tool swap), with a consistent
+// heuristic adding at most another 7, so every queued key lies in
+// [kmin, kmin + 14] and Dial's buckets need a ring of 15.
+//
+constexpr int max_weight {7};
+
+enum class engine { heap, pairing, bucket };
+
+template<typename G, typename D, typename H> search_result dijkstra(vertex_t from, vertex_t to, G const& g, D& d, H h, engine e)
+{
+    switch( e)
+    {
+        case engine::heap:
+            return aoc::dijkstra<aoc::binary_heap<int, vertex_t>>(g, from, to, d, h);
+        case engine::pairing:
+            return aoc::dijkstra<aoc::pairing_heap<int, vertex_t>>(g, from, to, d, h);
+        default:
+            return aoc::dijkstra<aoc::bucket_queue<int, vertex_t, 2 * max_weight + 1>>(g, from, to, d, h);
+    }
+}
+
+struct options
+{
+    engine  engine_  { engine::bucket};
+    bool    implicit_{ true};
+    bool    astar_   { false};
+    storage storage_ { storage::types};
+    unsigned threads_{ std::max(std::thread::hardware_concurrency(), 1u)};
+    aoc::arena* arena_{ nullptr}; // for the explicit graph, else the heap
+};
+
+template<typename G, typename D> search_result search(vertex_t from, vertex_t to, G const& g, D& d, pt tgt, options const& o)
+{
+    if( o.astar_)
+        return dijkstra(from, to, g, d, rescue_heuristic{tgt}, o.engine_);
+    return dijkstra(from, to, g, d, aoc::no_heuristic{}, o.engine_);
+}
+
+search_result pt2_explicit(pt tgt, int depth, options const& o, std::pmr::memory_resource* r, int margin)
+{
+    auto from = vertex_id_from_region_tool({0, 0}, torch);
+    auto to   = vertex_id_from_region_tool(tgt, torch);
+    auto g = build_graph(tgt, depth, o.storage_, o.threads_, r, margin);
+    dense_distances d(g.rect_.size(), g.rect_);
+    return search(from, to, g, d, tgt, o);
 }
 
-std::vector<int> dijkstra(vertex_t from, graph_t const& g)
+// an explicit graph built on o.arena_ is dropped by resetting the arena once
+// the solve is done, which keeps its memory for the next.
+//
+search_result pt2_within(pt tgt, int depth, options const& o, int margin)
 {
-    std::vector<int> d(g.size(), std::numeric_limits<int>::max());
-    std::vector<bool> inq(g.size(), true);
-    // find th4 offset o of the min value of 'd' for which inq[o] is true
-    // numeric_limits max if none
-    auto find_min = [&]() -> int
+    if( o.implicit_)
     {
-        auto m = std::numeric_limits<int>::max();
-        auto mx = std::numeric_limits<int>::max();
-        for(int n = 0; n < inq.size(); ++n)
-            if( inq[n] && d[n] < mx)
+        auto from = vertex_id_from_region_tool({0, 0}, torch);
+        auto to   = vertex_id_from_region_tool(tgt, torch);
+        cave_system cs { tgt, depth, o.storage_};
+        cave_graph  g { cs, search_rect(tgt, margin)};
+        sparse_distances d;
+        return search(from, to, g, d, tgt, o);
+    }
+    if( !o.arena_)
+        return pt2_explicit(tgt, depth, o, std::pmr::get_default_resource(), margin);
+    auto rv = pt2_explicit(tgt, depth, o, o.arena_, margin);
+    o.arena_->reset();
+    return rv;
+}
+
+// a route too long to be sure of within the default margin is searched for
+// again within the margin that is sure of it. the second route is no longer
+// than the first, so one widening is enough. there is no route at all when
+// the torch may not be held at the mouth.
+//
+search_result pt2(pt tgt, int depth, options const& o)
+{
+    auto rv = pt2_within(tgt, depth, o, search_margin);
+    if( rv.dist_ == aoc::unreached<int>)
+        return rv;
+    auto margin = search_margin_for(tgt, rv.dist_);
+    if( margin == search_margin)
+        return rv;
+    auto wider = pt2_within(tgt, depth, o, margin);
+    wider.expanded_ += rv.expanded_;
+    return wider;
+}
+
+void report(char const* what, search_result r, search_result base)
+{
+    if( r.dist_ == aoc::unreached<int>)
+    {
+        std::cout << what << " = no route\n";
+        return;
+    }
+    std::cout << what << " = " << r.dist_ << " (" << r.expanded_ << " expanded";
+    if( base.expanded_ != r.expanded_)
+        std::cout << ", dijkstra " << base.expanded_;
+    std::cout << ")\n";
+}
+
+// puzzle input is of the form
+//
+// depth: 7740
+// target: 12,763
+//
+bool get_input(char const* fn, int& d, pt& t)
+{
+    AOC_TIMED("parse");
+    std::ifstream in(fn);
+    std::string ln;
+    bool have_d { false};
+    bool have_t { false};
+    while(std::getline(in, ln))
+    {
+        if( std::sscanf(ln.c_str(), "depth: %d", &d) == 1)
+            have_d = true;
+        else
+        if( std::sscanf(ln.c_str(), "target: %d,%d", &t.x_, &t.y_) == 2)
+            have_t = true;
+    }
+    return have_d && have_t;
+}
+
+// pt1 over a large synthetic cave with 1 to n threads.
+//
+void scaling(unsigned threads, storage m)
+{
+    constexpr pt big_target { 1000, 100000};
+    std::cout << "pt1 scaling, target = " << big_target.x_ << ", " << big_target.y_ << '\n';
+    for( unsigned n = 1; n <= threads; ++n)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        auto rv = pt1(big_target, depth, m, n);
+        auto t1 = std::chrono::steady_clock::now();
+        std::cout << "threads " << n << " : " << std::chrono::duration<double, std::milli>(t1 - t0).count() << "ms (" << rv << ")\n";
+    }
+}
+
+// pt1 and pt2 again the plain way, as a check on all of the above. erosion
+// levels come straight from their definition, each row grown as far as the
+// search has needed, and the search is dijkstra over (region, tool) on a
+// std::priority_queue with no bound on the cave.
+//
+class plain_cave
+{
+    pt                                     t_;
+    int                                    d_;
+    std::vector<std::vector<std::int64_t>> el_; // by row, no row longer than the one above
+public:
+    plain_cave(pt t, int d) : t_{t}, d_{d}
+    {}
+    int type(pt p)
+    {
+        if( size_t(p.y_) < el_.size() && size_t(p.x_) < el_[p.y_].size())
+            return el_[p.y_][p.x_] % 3;
+        if( el_.size() <= size_t(p.y_))
+            el_.resize(p.y_ + 1);
+        for( int y = 0; y <= p.y_; ++y)
+            for( auto& row = el_[y]; row.size() <= size_t(p.x_); )
             {
-                m = n;
-                mx = d[n];
+                int x = row.size();
+                std::int64_t gi;
+                if( pt{x, y} == pt{0, 0} || pt{x, y} == t_)
+                    gi = 0;
+                else
+                if( y == 0)
+                    gi = x * std::int64_t(16807);
+                else
+                if( x == 0)
+                    gi = y * std::int64_t(48271);
+                else
+                    gi = row[x - 1] * el_[y - 1][x];
+                row.push_back((gi + d_) % 20183);
             }
-        return m;
-    };
-    auto u = from;
-    d[u] = 0;
-    while(u != std::numeric_limits<int>::max())
+        return el_[p.y_][p.x_] % 3;
+    }
+};
+
+std::pair<std::int64_t, int> check(pt t, int d)
+{
+    plain_cave cave { t, d};
+    std::int64_t risk {0};
+    for( int y = 0; y <= t.y_; ++y)
+        for( int x = 0; x <= t.x_; ++x)
+            risk += cave.type({x, y});
+    auto key = [](pt p, int tool){ return (std::uint64_t(p.y_) << 34) | (std::uint64_t(p.x_) << 2) | tool;};
+    using entry = std::tuple<int, int, int, int>; // minutes, x, y, tool
+    std::priority_queue<entry, std::vector<entry>, std::greater<>> q;
+    std::unordered_map<std::uint64_t, int> best;
+    auto reach = [&](pt p, int tool, int m)
     {
-        inq[u] = false;
-        for( auto v : g[u])
+        auto [it, added] = best.try_emplace(key(p, tool), m);
+        if( added || m < (*it).second)
         {
-            if(inq[v.to_] && (d[v.to_] > d[u] + v.wt_))
-                d[v.to_] = d[u] + v.wt_;
+            (*it).second = m;
+            q.emplace(m, p.x_, p.y_, tool);
         }
-        u = find_min();
+    };
+    if( cross_region(cave.type({0, 0}), torch))
+        reach({0, 0}, torch, 0);
+    while( !q.empty())
+    {
+        auto [m, x, y, tool] = q.top();
+        q.pop();
+        if( m > best[key({x, y}, tool)])
+            continue;
+        if( pt{x, y} == t && tool == torch)
+            return { risk, m};
+        int type = cave.type({x, y});
+        for( int other = 0; other < 3; ++other)
+            if( other != tool && cross_region(type, other))
+                reach({x, y}, other, m + 7);
+        for( pt n : { pt{x - 1, y}, pt{x + 1, y}, pt{x, y - 1}, pt{x, y + 1}})
+            if( n.x_ >= 0 && n.y_ >= 0 && cross_region(cave.type(n), tool))
+                reach(n, tool, m + 1);
     }
-    return d;
+    return { risk, -1};
 }
 
-int pt2(pt tgt, int depth)
-{
-    auto g = build_graph(tgt, depth);
-    auto d = dijkstra(vertex_id_from_region_tool({0, 0}, torch), g);
-    return d[vertex_id_from_region_tool(tgt, torch)];
 }
 
-int main()
+#if defined(AOC_RUNNER)
+#include <runner/runner.h>
+
+// pt1 and pt2 each fill their own cave, so they share only the input. each
+// is single threaded, the pool running them side by side.
+//
+AOC_RUNNER_ENTRY(aoc2018_22, "2018-22",
+    [](char const* fn)
+    {
+        std::pair<pt, int> in { target, depth};
+        if( fn && !get_input(fn, in.second, in.first))
+            throw std::runtime_error(std::string("no depth and target in ") + fn);
+        return in;
+    },
+    [](auto const& in){ return std::to_string(pt1(in.first, in.second, storage::types, 1));},
+    [](auto const& in)
+    {
+        options o;
+        o.threads_ = 1;
+        return std::to_string(pt2(in.first, in.second, o).dist_);
+    })
+#endif
+
+#if !defined(AOC_BENCH) && !defined(AOC_RUNNER)
+#include <common/instrument_alloc.h>
+
+using namespace aoc2018_22;
+
+// usage : aoc2018_22 [heap|pairing|bucket] [implicit|explicit] [astar] [levels|types] [arena] [check] [--threads N] [--scaling] [input file]
+//
+// arena builds every explicit graph on one arena, reused from solve to solve.
+//
+int main(int ac, char* av[])
 {
-    auto p1t = pt1(test_target, test_depth);
+    options o;
+    aoc::arena a;
+    int d { depth};
+    pt  t { target};
+    bool scale { false };
+    bool chk { false };
+    for( int n = 1; n < ac; ++n)
+    {
+        std::string_view arg { av[n]};
+        if( arg == "--threads" && n + 1 < ac)
+            o.threads_ = std::max(std::atoi(av[++n]), 1);
+        else
+        if( arg == "--scaling")
+            scale = true;
+        else
+        if( arg == "heap")
+            o.engine_ = engine::heap;
+        else
+        if( arg == "pairing")
+            o.engine_ = engine::pairing;
+        else
+        if( arg == "bucket")
+            o.engine_ = engine::bucket;
+        else
+        if( arg == "implicit")
+            o.implicit_ = true;
+        else
+        if( arg == "explicit")
+            o.implicit_ = false;
+        else
+        if( arg == "astar")
+            o.astar_ = true;
+        else
+        if( arg == "levels")
+            o.storage_ = storage::levels;
+        else
+        if( arg == "types")
+            o.storage_ = storage::types;
+        else
+        if( arg == "arena")
+            o.arena_ = &a;
+        else
+        if( arg == "check")
+            chk = true;
+        else
+        if( !get_input(av[n], d, t))
+        {
+            std::cout << "usage : " << av[0] << " [heap|pairing|bucket] [implicit|explicit] [astar] [levels|types] [arena] [check] [--threads N] [--scaling] [input file]\n";
+            return 1;
+        }
+    }
+    if( scale)
+    {
+        scaling(o.threads_, o.storage_);
+        return 0;
+    }
+    std::cout << "engine     = " << (o.engine_ == engine::heap ? "heap" : o.engine_ == engine::pairing ? "pairing" : "bucket") << (o.implicit_ ? ", implicit" : ", explicit") << " graph" << (o.astar_ ? ", A*" : "")
+              << (o.storage_ == storage::levels ? ", erosion levels" : ", region types") << (o.arena_ && !o.implicit_ ? ", arena" : "") << ", " << o.threads_ << " threads\n";
+    auto p1t = pt1(test_target, test_depth, o.storage_, o.threads_);
     std::cout << "pt1 (test) = " << p1t << '\n';
-    auto p1 = pt1(target, depth);
+    std::cout << "depth      = " << d << ", target = " << t.x_ << ", " << t.y_ << '\n';
+    auto p1 = aoc::timed("pt1       ", [&]{ return pt1(t, d, o.storage_, o.threads_);});
     std::cout << "pt1        = " << p1 << '\n';
-    auto p2t = pt2(test_target, test_depth);
-    std::cout << "pt2 (test) = " << p2t << '\n';
-    auto p2 = pt2(target, depth);
-   std::cout << "pt2        = " << p2 << '\n';
-}
\ No newline at end of file
+    auto base = o;
+    base.astar_ = false;
+    auto p2t = aoc::timed("pt2 (test)", [&]{ return pt2(test_target, test_depth, o);});
+    auto p2tb = o.astar_ ? pt2(test_target, test_depth, base) : p2t;
+    report("pt2 (test)", p2t, p2tb);
+    auto p2 = aoc::timed("pt2       ", [&]{ return pt2(t, d, o);});
+    auto p2b = o.astar_ ? pt2(t, d, base) : p2;
+    report("pt2       ", p2, p2b);
+    if( o.arena_ && !o.implicit_)
+        std::cout << "arena      = " << a.capacity() << " bytes in " << a.blocks() << " block\n";
+    if( chk)
+    {
+        auto [c1, c2] = aoc::timed("check     ", [&]{ return check(t, d);});
+        std::cout << "pt1 (check) = " << c1 << '\n';
+        if( c2 < 0)
+            std::cout << "pt2 (check) = no route\n";
+        else
+            std::cout << "pt2 (check) = " << c2 << '\n';
+    }
+}
+#endif
@@ -3,102 +3,208 @@
 #include <string>
 #include <algorithm>
 #include <array>
+#include <limits>
+#include <cstdint>
+#include <bit>
+#include <cmath>
+#include <chrono>
+#include <tuple>
+#include <string_view>
+#include <span>
+#include <optional>
 #include <map>
 #include <queue>
+#include <utility>
 
+#include <common/input.h>
+#include <common/graph.h>
+#include <common/snapshot.h>
+#include <common/instrument.h>
+
+namespace aoc2019_20
+{
+
+// a portal is named by two capital letters, which pack into 10 bits. AA is
+// the lowest id and ZZ the highest.
+//
+constexpr int portal_ids = 26 * 26;
+
+int portal_id(char c1, char c2)
+{
+    return (c1 - 'A') * 26 + (c2 - 'A');
+}
+
+std::string portal_name(int id)
+{
+    return { char('A' + id / 26), char('A' + id % 26) };
+}
+
+struct portal_t
+{
+    int id_;
+    int outer_; // position of the open tile by each side, 0 if not present
+    int inner_;
+};
+
+// the maze is a bit per tile, set if it is open, and the portal side (if any)
+// at each tile, with the outer side of the n'th portal numbered n and the
+// inner side n + vertices_.size(). positions are y * sx_ + x.
+//
 struct arena_t
 {
-    std::vector<char> donut_;
     int sx_;
-    std::map<std::string, std::pair<int, int>> vertices_; // name, outer pos in donut, inner pos in donut. pos 0 is not present.
+    int sy_;
+    std::vector<std::uint64_t> open_;
+    std::vector<std::int16_t>  side_;
+    std::vector<portal_t>      vertices_; // in id order
+    bool open(int p) const
+    {
+        return open_[p >> 6] >> (p & 63) & 1;
+    }
 };
 
-arena_t get_arena()
+// the input as lines padded to the same width, which needn't be the height.
+//
+std::vector<std::string_view> get_lines(std::string_view txt, int& sx)
 {
+    std::vector<std::string_view> lns;
+    sx = 0;
+    for (auto ln : aoc::lines(txt))
+    {
+        lns.push_back(ln);
+        sx = std::max<int>(sx, ln.size());
+    }
+    return lns;
+}
+
+arena_t get_arena(aoc::input const& in)
+{
+    AOC_TIMED("parse");
     arena_t a;
 
     // read the input
-    std::string ln;
-    std::getline(std::cin, ln);
-    auto sx = ln.length();
-    std::cout << "sx = " << sx << '\n';
-    a.donut_.reserve(sx * sx); // it's square
-    a.donut_.assign(ln.begin(), ln.end());
-    while(std::getline(std::cin, ln))
-        a.donut_.insert(a.donut_.end(), ln.begin(), ln.end() );
-
-    // parse out vertices
-    for (int n = 0; n < a.donut_.size() - sx; ++n)
+    auto lns = get_lines(in.text(), a.sx_);
+    a.sy_ = lns.size();
+    auto at = [&](int x, int y) -> char
     {
-        if (::isalpha(a.donut_[n]))
+        if (y < 0 || y >= a.sy_ || x < 0 || x >= int(lns[y].size()))
+            return ' ';
+        return lns[y][x];
+    };
+    auto is_letter = [](char c) { return c >= 'A' && c <= 'Z'; };
+    a.open_.resize((a.sx_ * a.sy_ + 63) / 64);
+    for (int y = 0; y < a.sy_; ++y)
+        for (int x = 0; x < a.sx_; ++x)
+            if (at(x, y) == '.')
+                a.open_[(y * a.sx_ + x) >> 6] |= std::uint64_t{1} << ((y * a.sx_ + x) & 63);
+
+    // parse out vertices. a name reads down or across, and its open tile is
+    // just beyond one end of it. the outer sides are on the edge of the donut.
+    std::array<portal_t, portal_ids> by_id {};
+    for (int y = 0; y < a.sy_; ++y)
+        for (int x = 0; x < a.sx_; ++x)
         {
-            bool outer = true;
-            int vp = 0;
-            std::string nm;
-            if (::isalpha(a.donut_[n + sx])) // vertical
+            if (!is_letter(at(x, y)))
+                continue;
+            int id = -1;
+            int tx = 0, ty = 0;
+            if (is_letter(at(x, y + 1))) // vertical
             {
-                nm = a.donut_[n];
-                nm += a.donut_[n + sx];
-                if (n < sx) // top
-                    vp = n + 2 * sx;
-                else
-                if (n < a.donut_.size() / 2) // upper inner
-                {
-                    vp = n - sx;
-                    outer = false;
-                }
-                else
-                if (n < a.donut_.size() - 2 * sx) // lower inner
-                {
-                    vp = n + 2 * sx;
-                    outer = false;
-                }
-                else
-                    vp = n - sx;
+                id = portal_id(at(x, y), at(x, y + 1));
+                tx = x;
+                ty = at(x, y + 2) == '.' ? y + 2 : y - 1;
             }
             else
-            if (::isalpha(a.donut_[n + 1])) // horizontal
-            {
-                nm = a.donut_[n];
-                nm += a.donut_[n + 1];
-                if (n % sx == 0) // left 
-                    vp = n + 2;
-                else
-                if (n % sx < sx / 2) // left inner
-                {
-                    vp = n - 1;
-                    outer = false;
-                }
-                else
-                if (n % sx == sx - 2) // right
-                    vp = n - 1;
-                else
-                {
-                    vp = n + 2;
-                    outer = false;
-                }
-            }
-            if (vp)
+            if (is_letter(at(x + 1, y))) // horizontal
             {
-                if (outer)
-                    a.vertices_[nm].first = vp;
-                else
-                    a.vertices_[nm].second = vp;
+                id = portal_id(at(x, y), at(x + 1, y));
+                tx = at(x + 2, y) == '.' ? x + 2 : x - 1;
+                ty = y;
             }
+            if (id == -1 || at(tx, ty) != '.')
+                continue;
+            by_id[id].id_ = id;
+            bool outer = tx == 2 || ty == 2 || tx == a.sx_ - 3 || ty == a.sy_ - 3;
+            (outer ? by_id[id].outer_ : by_id[id].inner_) = ty * a.sx_ + tx;
         }
+    for (auto& p : by_id)
+        if (p.outer_ || p.inner_)
+            a.vertices_.push_back(p);
+
+    int nv = a.vertices_.size();
+    a.side_.assign(a.sx_ * a.sy_, -1);
+    for (int v = 0; v < nv; ++v)
+    {
+        if (a.vertices_[v].outer_)
+            a.side_[a.vertices_[v].outer_] = v;
+        if (a.vertices_[v].inner_)
+            a.side_[a.vertices_[v].inner_] = v + nv;
     }
-    a.sx_ = sx;
     return a;
 }
 
 void print_vertices(arena_t const& a)
 {
     for(auto& vp : a.vertices_)
-        std::cout << vp.first << " : " << vp.second.first << ", " << vp.second.second << '\n';
+        std::cout << portal_name(vp.id_) << " : " << vp.outer_ << ", " << vp.inner_ << '\n';
 }
 
 using can_move_set = std::array<int, 4>;
 can_move_set get_moves(arena_t const& a, int p)
+{
+    can_move_set cms;
+    cms[0] = a.open(p - a.sx_) ? p - a.sx_ : -1;
+    cms[1] = a.open(p + a.sx_) ? p + a.sx_ : -1;
+    cms[2] = a.open(p - 1) ? p - 1 : -1;
+    cms[3] = a.open(p + 1) ? p + 1 : -1;
+
+    return cms;
+}
+
+template<typename F> void for_each_edge(arena_t const& a, int p, F f)
+{
+    for (auto q : get_moves(a, p))
+        if (q != -1)
+            f(q, 1);
+}
+
+// distances from s over either layout, -1 where s can't reach.
+//
+template<typename A> std::vector<int> bfs(A const& a, int s, size_t tiles)
+{
+    aoc::dense_distances<int> d(tiles);
+    aoc::bfs(a, s, d);
+    auto rv = d.distances();
+    std::replace(rv.begin(), rv.end(), aoc::unreached<int>, -1);
+    return rv;
+}
+
+std::vector<int> bfs(arena_t const& a, int s)
+{
+    return bfs(a, s, a.sx_ * a.sy_);
+}
+
+// the maze as raw characters, as it used to be held, to compare against.
+//
+struct char_arena_t
+{
+    std::vector<char> donut_;
+    int sx_;
+};
+
+char_arena_t get_char_arena(aoc::input const& in)
+{
+    char_arena_t ca;
+    auto lns = get_lines(in.text(), ca.sx_);
+    for (auto ln : lns)
+    {
+        ca.donut_.insert(ca.donut_.end(), ln.begin(), ln.end());
+        ca.donut_.resize(ca.donut_.size() + ca.sx_ - ln.size(), ' ');
+    }
+    return ca;
+}
+
+can_move_set get_moves(char_arena_t const& a, int p)
 {
     can_move_set cms;
     cms[0] = a.donut_[p - a.sx_] == '.' ? p - a.sx_ : -1;
@@ -109,28 +215,16 @@ can_move_set get_moves(arena_t const& a, int p)
     return cms;
 }
 
-std::vector<int> bfs(arena_t const& a, int s)
+template<typename F> void for_each_edge(char_arena_t const& a, int p, F f)
 {
-    std::vector <int> d(a.donut_.size(), -1);
-    std::queue<size_t> q;
-    q.push(s);
-    d[s] = 0;
-    while (!q.empty())
-    {
-        auto p = q.front(); q.pop();
-
-        auto cms = get_moves(a, p);
-        for (auto& v : cms)
-        {
-            if (v != -1 && (d[v] == -1))
-            {
-                d[v] = d[p] + 1;
-                q.push(v);
-            }
-        }
-    }
+    for (auto q : get_moves(a, p))
+        if (q != -1)
+            f(q, 1);
+}
 
-    return d;
+std::vector<int> bfs(char_arena_t const& a, int s)
+{
+    return bfs(a, s, a.donut_.size());
 }
 
 struct edge_store_t
@@ -144,166 +238,644 @@ struct edge_store_t
 
 struct edge_store
 {
-    // convenience store for vertex names
-    std::vector<std::string> vnm_;
+    // portal id of each vertex
+    std::vector<int> ids_;
     // list of derived weighted edges
-    // the first vnm_.size vertex_ids are on the outside, the next on the inside
+    // the first ids_.size vertex_ids are on the outside, the next on the inside
     // there are two redundant spaces since AA and ZZ aren't present internally.
     std::vector<edge_store_t> edges_;
 };
 
+// what the solvers need of an edge store, either one just built or one used
+// in place from a snapshot.
+//
+struct edge_store_view
+{
+    std::span<const int>          ids_;
+    std::span<const edge_store_t> edges_;
+
+    int size() const
+    {
+        return ids_.size();
+    }
+    std::string name(int v) const
+    {
+        return portal_name(ids_[v % size()]);
+    }
+};
+
+edge_store_view view(edge_store const& es)
+{
+    return { es.ids_, es.edges_ };
+}
+
+// tile distances kept from one bfs to the next and reset only where the last
+// reached, so a bfs costs the tiles it reaches rather than the whole donut.
+//
+class region_distances
+{
+    std::vector<int> d_;
+    std::vector<int> reached_;
+public:
+    using weight_type = int;
+    explicit region_distances(size_t tiles) : d_(tiles, aoc::unreached<int>)
+    {}
+    int get(int p) const
+    {
+        return d_[p];
+    }
+    void set(int p, int d, int)
+    {
+        if (d_[p] == aoc::unreached<int>)
+            reached_.push_back(p);
+        d_[p] = d;
+    }
+    void clear()
+    {
+        for (auto p : reached_)
+            d_[p] = aoc::unreached<int>;
+        reached_.clear();
+    }
+};
+
+// one bfs from each side of every portal, each costing only the tiles that
+// side reaches. the default build, see build_edge_store_sweep.
+//
 edge_store build_edge_store(arena_t const& a)
 {
+    AOC_TIMED("build_edge_store");
     edge_store es;
-    int vid_f = 0;
+    int nv = a.vertices_.size();
     for (auto& v : a.vertices_)
+        es.ids_.push_back(v.id_);
+    region_distances d(a.sx_ * a.sy_);
+    for (int s = 0; s < nv * 2; ++s)
     {
-        es.vnm_.emplace_back(v.first);
-        auto d = bfs(a, v.second.first);
-        int vid_t = 0;
-        for (auto& e : a.vertices_)
-        {
-            if (d[e.second.first] > 0)
-                es.edges_.emplace_back(vid_f, vid_t, d[e.second.first]);
-            if (d[e.second.second] > 0)
-                es.edges_.emplace_back(vid_f, vid_t + a.vertices_.size(), d[e.second.second]);
-            ++vid_t;
-        }
-        d = bfs(a, v.second.second);
-        auto vid_f2 { vid_f + a.vertices_.size()};
-        vid_t = 0;
-        for (auto& e : a.vertices_)
+        auto& v = a.vertices_[s % nv];
+        auto pos = s < nv ? v.outer_ : v.inner_;
+        if (pos == 0) // AA and ZZ have no inner side
+            continue;
+        aoc::bfs(a, pos, d);
+        for (int t = 0; t < nv; ++t)
         {
-            if (d[e.second.first] > 0)
-                es.edges_.emplace_back(vid_f2, vid_t, d[e.second.first]);
-            if (d[e.second.second] > 0)
-                es.edges_.emplace_back(vid_f2, vid_t + a.vertices_.size(), d[e.second.second]);
-            ++vid_t;
+            auto& e = a.vertices_[t];
+            if (e.outer_ && d.get(e.outer_) != aoc::unreached<int> && d.get(e.outer_) > 0)
+                es.edges_.emplace_back(s, t, d.get(e.outer_));
+            if (e.inner_ && d.get(e.inner_) != aoc::unreached<int> && d.get(e.inner_) > 0)
+                es.edges_.emplace_back(s, t + nv, d.get(e.inner_));
         }
-        ++vid_f;
+        d.clear();
     }
 
     return es;
 }
 
-void print_edge_store(edge_store const& es)
+// all the portal to portal distances in one sweep per 64 portal sides. each
+// open tile carries a bit per source that has reached it, and each level moves
+// the bits that first arrived on the last level on to the neighbours. a tile
+// is visited once per level on which new bits reach it, rather than once per
+// source, and the bits arriving at a portal tile are its distances.
+//
+// in the open the sources reach a tile on as many different levels as there
+// are sources, so the sweep does as many visits as a bfs per side, each
+// dearer. where walls shut the sources into small regions, each bfs is small
+// too. it's slower than build_edge_store at every wall density tried, and
+// kept to check it by.
+//
+edge_store build_edge_store_sweep(arena_t const& a)
 {
-    for(auto& e : es.edges_)
+    AOC_TIMED("build_edge_store_sweep");
+    edge_store es;
+    int nv = a.vertices_.size();
+    std::vector<int> sources(nv * 2); // portal side position, by vertex id, 0 if absent
+    for (int v = 0; v < nv; ++v)
     {
-        auto& fnm = es.vnm_[e.f_ % es.vnm_.size()];
-        auto& tnm = es.vnm_[e.t_ % es.vnm_.size()];
-        std::cout << fnm << " -> " << tnm << " (" << e.w_ << ")\n";
+        es.ids_.push_back(a.vertices_[v].id_);
+        sources[v]      = a.vertices_[v].outer_;
+        sources[v + nv] = a.vertices_[v].inner_;
     }
-}
-
-struct edge_t
-{
-    int to_;
-    int wt_;
-};
-
-using graph_t = std::vector<std::vector<edge_t>>;
-
-void add_edge(int v1, int v2, int wt, graph_t& g)
-{
-    g[v1].push_back({v2, wt});
-    g[v2].push_back({v1, wt});
-}
+    // sources close together reach a tile on close levels, so batch them
+    // in order around the donut.
+    std::vector<int> order;
+    for (int s = 0; s < nv * 2; ++s)
+        if (sources[s])
+            order.push_back(s);
+    auto angle = [&](int s)
+    {
+        auto p = sources[s];
+        return std::atan2(p / a.sx_ - a.sy_ / 2.0, p % a.sx_ - a.sx_ / 2.0);
+    };
+    std::sort(order.begin(), order.end(), [&](int l, int r){ return angle(l) < angle(r);});
 
-std::vector<int> dijkstra(int from, graph_t const& g)
-{
-    std::vector<int> d(g.size(), std::numeric_limits<int>::max());
-    std::vector<bool> inq(g.size(), true);
-    // find th4 offset o of the min value of 'd' for which inq[o] is true
-    // numeric_limits max if none
-    auto find_min = [&]() -> int
+    size_t tiles = a.sx_ * a.sy_;
+    std::vector<std::uint64_t> seen(tiles);
+    std::vector<std::uint64_t> frontier(tiles);
+    std::vector<std::uint64_t> next(tiles);
+    std::vector<int> cur_tiles;
+    std::vector<int> next_tiles;
+    std::vector<int> touched;
+    size_t visits { 0 };
+    for (size_t base = 0; base < order.size(); base += 64)
     {
-        auto m = std::numeric_limits<int>::max();
-        auto mx = std::numeric_limits<int>::max();
-        for(int n = 0; n < inq.size(); ++n)
-            if( inq[n] && d[n] < mx)
+        std::vector<int> batch; // vertex id for each bit
+        for (auto o = base; o < std::min(base + 64, order.size()); ++o)
+        {
+            auto s = order[o];
+            auto p = sources[s];
+            auto bit = std::uint64_t{1} << batch.size();
+            batch.push_back(s);
+            if (!seen[p])
             {
-                m = n;
-                mx = d[n];
+                cur_tiles.push_back(p);
+                touched.push_back(p);
             }
-        return m;
-    };
-    auto u = from;
-    d[u] = 0;
-    while(u != std::numeric_limits<int>::max())
-    {
-        inq[u] = false;
-        for( auto v : g[u])
+            seen[p]     |= bit;
+            frontier[p] |= bit;
+        }
+        for (int level = 1; !cur_tiles.empty(); ++level)
         {
-            if(inq[v.to_] && (d[v.to_] > d[u] + v.wt_))
-                d[v.to_] = d[u] + v.wt_;
+            visits += cur_tiles.size();
+            for (auto p : cur_tiles)
+            {
+                for (auto q : get_moves(a, p))
+                {
+                    if (q == -1)
+                        continue;
+                    auto arrive = frontier[p] & ~seen[q];
+                    if (!arrive)
+                        continue;
+                    if (!seen[q])
+                        touched.push_back(q);
+                    if (!next[q])
+                        next_tiles.push_back(q);
+                    seen[q] |= arrive;
+                    next[q] |= arrive;
+                    if (a.side_[q] != -1)
+                        for (; arrive; arrive &= arrive - 1)
+                            es.edges_.emplace_back(batch[std::countr_zero(arrive)], a.side_[q], level);
+                }
+            }
+            for (auto p : cur_tiles)
+                frontier[p] = 0;
+            std::swap(frontier, next);
+            std::swap(cur_tiles, next_tiles);
+            next_tiles.clear();
         }
-        u = find_min();
+        for (auto p : touched)
+            seen[p] = 0;
+        touched.clear();
     }
-    return d;
+    AOC_COUNT("sweep tile visits", visits);
+    AOC_COUNT("edge store edges", es.edges_.size());
+
+    return es;
 }
 
+void print_edge_store(edge_store_view const& es)
+{
+    for(auto& e : es.edges_)
+        std::cout << es.name(e.f_) << " -> " << es.name(e.t_) << " (" << e.w_ << ")\n";
+}
+
+using graph_t = aoc::adjacency_list<int, int>;
+
 void print_graph(graph_t const& g)
 {
-    int n = 0;
-    for(auto& al : g)
+    for(size_t n = 0; n < g.size(); ++n)
     {
         std::cout << n << " : " ;
-        for(auto& t : al)
+        for(auto& t : g[n])
             std::cout << t.to_ << ' ';
         std::cout << '\n';
-        ++n;
     }
 }
 
-int pt1(edge_store const& es)
+// a step on a route, arriving at a portal side on a level.
+//
+struct route_step
+{
+    int v_;
+    int level_;
+    int dist_;
+};
+
+using route_t = std::vector<route_step>;
+
+void print_route(edge_store_view const& es, route_t const& r)
+{
+    int nv = es.size();
+    for (auto& s : r)
+        std::cout << "  " << s.dist_ << ' ' << es.name(s.v_) << (s.v_ < nv ? " outer" : " inner") << " level " << s.level_ << '\n';
+}
+
+struct route_result
+{
+    int     dist_;  // -1 if ZZ can't be reached
+    route_t route_; // AA to ZZ, empty if no route
+};
+
+route_result pt1(edge_store_view const& es, bool verbose)
 {
     // install the edges in a graph
-    int nv = es.vnm_.size(); // number of outside vertices
+    int nv = es.size(); // number of outside vertices
     graph_t g(nv * 2); // each named vertex represents two (apart from AA and ZZ) actual vertices
     for(auto& e : es.edges_)
-        add_edge(e.f_, e.t_, e.w_, g);
+        g.add_undirected_edge(e.f_, e.t_, e.w_);
     // make the part one connections, to link inside and outside versions of each vertex
     // assume AA is first and ZZ is last, with a count of N, then link 1, N + 1 -> N - 2, 2N - 2
     for ( int v = 1; v < nv - 1; ++v)
-        add_edge(v, v + nv, 1, g);
-    print_graph(g);
+        g.add_undirected_edge(v, v + nv, 1);
+    if (verbose)
+        print_graph(g);
     // now do the dijkstra thing,source vertex is 0, target is nv - 1;
-    auto d = dijkstra(0, g);
+    aoc::dense_paths<int, int> d(g.size());
+    auto r = aoc::dijkstra<aoc::binary_heap<int, int>>(g, 0, nv - 1, d);
 
-    return d[nv - 1];
+    route_result rv { -1, {} };
+    if (r.dist_ == aoc::unreached<int>)
+        return rv;
+    rv.dist_ = r.dist_;
+    for (auto v : aoc::path(d, 0, nv - 1))
+        rv.route_.push_back({v, 0, d.get(v)});
+    return rv;
 }
 
-int pt2(edge_store const& es)
+struct level_search_result
 {
-    int nv = es.vnm_.size(); // number of outside vertices
-    // install the base
-    graph_t g(nv * 2 * 33); // each named vertex represents two (apart from AA and ZZ) actual vertices, account for 32 copies
-    // repeat more times,
-    for( int cnt = 0; cnt < 32; ++cnt)
+    int    dist_;      // -1 if ZZ can't be reached within max_level
+    int    max_level_; // deepest level expanded
+    size_t expanded_;
+    route_t route_;     // AA to ZZ, empty if no route
+};
+
+// part 2 searches (vertex, level) states, with each level's edges those of
+// the edge store and the portal edges between levels made as states are
+// expanded. only states reached are stored, with the state each was reached
+// from so the route can be followed back.
+//
+using state_t = std::uint64_t; // level << 32 | vertex
+
+state_t state(int v, int l)
+{
+    return state_t(l) << 32 | std::uint32_t(v);
+}
+
+// ZZ is on level 0 and each level down needs a step back up, reached by
+// walking to an outer portal, so a vertex on level l is at least
+// l * (1 + shortest edge) from ZZ, plus another shortest edge from an inner
+// side. that orders the search (A*).
+//
+struct level_heuristic
+{
+    int nv_;
+    int wmin_;
+    int operator()(state_t s) const
     {
-        int base_vertex = cnt * (nv * 2);
-        // install a copy
-        for(auto& e : es.edges_)
-            add_edge(e.f_ + base_vertex, e.t_ + base_vertex, e.w_, g);
-        // join inside of parent to outside of child
-        for ( int v = 1; v < nv - 1; ++v)
-            add_edge(v + base_vertex + nv, v + 2 * nv + base_vertex, 1, g);
+        return int(s >> 32) * (1 + wmin_) + (int(std::uint32_t(s)) >= nv_ ? wmin_ : 0);
     }
-    // now do the dijkstra thing,source vertex is 0, target is nv - 1;
-    auto d = dijkstra(0, g);
+};
+
+using level_distances = aoc::sparse_paths<state_t, int>;
+
+// the graph reads the search's own distances back, so that once ZZ has been
+// reached, states and the levels too deep to beat that route aren't made.
+//
+struct level_graph
+{
+    graph_t const&         g_;
+    int                    nv_;
+    int                    max_level_;
+    level_heuristic        h_;
+    level_distances const& d_;
+    mutable int            deepest_; // deepest level expanded
+};
+
+template<typename F> void for_each_edge(level_graph const& lg, state_t s, F f)
+{
+    int u = std::uint32_t(s);
+    int l = s >> 32;
+    int nv = lg.nv_;
+    lg.deepest_ = std::max(lg.deepest_, l);
+    auto best = lg.d_.get(state(nv - 1, 0)); // unreached<int> until ZZ is reached
+    auto du   = lg.d_.get(s);
+    auto edge = [&](state_t t, int w)
+    {
+        if (du + w + lg.h_(t) < best)
+            f(t, w);
+    };
+    for (auto& e : lg.g_[u])
+        edge(state(e.to_, l), e.wt_);
+    // AA and ZZ are not portals
+    if (u > nv && u < 2 * nv - 1 && l < lg.max_level_) // inner side, down a level
+        edge(state(u - nv, l + 1), 1);
+    else
+    if (u > 0 && u < nv - 1 && l > 0)                 // outer side, up a level
+        edge(state(u + nv, l - 1), 1);
+}
+
+// a route over levels is a part 1 route with the levels forgotten, so when
+// part 1 has none there's no searching the levels down to max_level.
+//
+level_search_result pt2(edge_store_view const& es, int max_level)
+{
+    int nv = es.size(); // number of outside vertices
+    if (pt1(es, false).dist_ < 0)
+        return { -1, 0, 0, {} };
+    graph_t g(nv * 2);
+    int wmin = std::numeric_limits<int>::max();
+    for(auto& e : es.edges_)
+    {
+        g.add_undirected_edge(e.f_, e.t_, e.w_);
+        wmin = std::min(wmin, e.w_);
+    }
+    if (es.edges_.empty())
+        wmin = 1;
+    level_heuristic h { nv, wmin };
+
+    level_distances d;
+    level_graph lg { g, nv, max_level, h, d, 0 };
+    auto r = aoc::astar(lg, state(0, 0), state(nv - 1, 0), d, h);
+    level_search_result rv { -1, lg.deepest_, r.expanded_, {} };
+    if (r.dist_ == aoc::unreached<int>)
+        return rv;
+    rv.dist_ = r.dist_;
+    for (auto s : aoc::path(d, state(0, 0), state(nv - 1, 0)))
+        rv.route_.push_back({int(std::uint32_t(s)), int(s >> 32), d.get(s)});
+    return rv;
+}
+
+// bfs from every portal side over the raw characters and over the bitplane,
+// then build the edge store both ways, and check each pair agrees.
+//
+void compare(arena_t const& a, char_arena_t const& ca)
+{
+    std::vector<int> sources;
+    for (auto& v : a.vertices_)
+        for (auto p : { v.outer_, v.inner_ })
+            if (p)
+                sources.push_back(p);
+    auto all_bfs = [&](auto const& arena)
+    {
+        std::vector<std::vector<int>> rv;
+        for (auto s : sources)
+            rv.push_back(bfs(arena, s));
+        return rv;
+    };
+    auto d1 = aoc::timed("bfs, characters    ", [&]{ return all_bfs(ca);});
+    auto d2 = aoc::timed("bfs, bitplane      ", [&]{ return all_bfs(a);});
+    std::cout << sources.size() << " bfs, " << (d1 == d2 ? "same\n" : "DIFFERENT\n");
+
+    auto key = [](edge_store_t const& e){ return std::tuple(e.f_, e.t_, e.w_);};
+    auto sorted = [&](edge_store es)
+    {
+        std::sort(es.edges_.begin(), es.edges_.end(), [&](auto& l, auto& r){ return key(l) < key(r);});
+        return es;
+    };
+    auto es1 = sorted(aoc::timed("bfs per portal side", [&]{ return build_edge_store(a);}));
+    auto es2 = sorted(aoc::timed("bit parallel       ", [&]{ return build_edge_store_sweep(a);}));
+    bool same = es1.edges_.size() == es2.edges_.size() &&
+                std::equal(es1.edges_.begin(), es1.edges_.end(), es2.edges_.begin(), [&](auto& l, auto& r){ return key(l) == key(r);});
+    std::cout << es1.edges_.size() << " edges, " << (same ? "same\n" : "DIFFERENT\n");
+}
+
+// both parts again the plain way, as a check on all of the above. a bfs over
+// the characters as they are, a step through a portal being one more, and
+// for part 2 over (tile, level) as far down as max_level. -1 if ZZ isn't
+// reached.
+//
+std::pair<int, int> check(aoc::input const& in, int max_level)
+{
+    std::vector<std::string> grid;
+    for (auto ln : aoc::lines(in.text()))
+        grid.emplace_back(ln);
+    int sy = grid.size();
+    int sx = 0;
+    for (auto& ln : grid)
+        sx = std::max<int>(sx, ln.size());
+    for (auto& ln : grid)
+        ln.resize(sx, ' ');
+    auto at = [&](int x, int y)
+    {
+        return x < 0 || y < 0 || x >= sx || y >= sy ? ' ' : grid[y][x];
+    };
+    auto is_letter = [](char c) { return c >= 'A' && c <= 'Z'; };
+    constexpr int dx[] { 1, -1, 0, 0 };
+    constexpr int dy[] { 0, 0, 1, -1 };
+
+    // each open tile by a name, the name read in the direction away from it.
+    // the outer sides have their names on the edge.
+    struct side { int x_; int y_; bool outer_; };
+    std::map<std::string, std::vector<side>> named;
+    for (int y = 0; y < sy; ++y)
+        for (int x = 0; x < sx; ++x)
+            if (at(x, y) == '.')
+                for (int d = 0; d < 4; ++d)
+                {
+                    char c1 = at(x + dx[d], y + dy[d]);
+                    char c2 = at(x + 2 * dx[d], y + 2 * dy[d]);
+                    if (!is_letter(c1) || !is_letter(c2))
+                        continue;
+                    std::string name = dx[d] + dy[d] > 0 ? std::string{c1, c2} : std::string{c2, c1};
+                    int fx = x + 2 * dx[d];
+                    int fy = y + 2 * dy[d];
+                    named[name].push_back({x, y, fx == 0 || fy == 0 || fx == sx - 1 || fy == sy - 1});
+                }
+    if (named["AA"].empty() || named["ZZ"].empty())
+        return { -1, -1 };
+    auto aa = named["AA"].front();
+    auto zz = named["ZZ"].front();
+    // where a step through the portal at each open tile leads, and whether
+    // it leads up a level.
+    std::map<std::pair<int, int>, side> warp;
+    for (auto& [name, sides] : named)
+        if (sides.size() == 2)
+        {
+            warp[{ sides[0].x_, sides[0].y_ }] = { sides[1].x_, sides[1].y_, sides[0].outer_ };
+            warp[{ sides[1].x_, sides[1].y_ }] = { sides[0].x_, sides[0].y_, sides[1].outer_ };
+        }
+
+    auto search = [&](bool levels)
+    {
+        std::vector<std::vector<int>> dist; // by level, then tile
+        auto reach = [&](std::queue<std::tuple<int, int, int>>& q, int x, int y, int l, int d)
+        {
+            if (int(dist.size()) <= l)
+                dist.resize(l + 1);
+            if (dist[l].empty())
+                dist[l].assign(sx * sy, -1);
+            if (dist[l][y * sx + x] == -1)
+            {
+                dist[l][y * sx + x] = d;
+                q.emplace(x, y, l);
+            }
+        };
+        std::queue<std::tuple<int, int, int>> q;
+        reach(q, aa.x_, aa.y_, 0, 0);
+        while (!q.empty())
+        {
+            auto [x, y, l] = q.front();
+            q.pop();
+            int d = dist[l][y * sx + x];
+            if (x == zz.x_ && y == zz.y_ && l == 0)
+                return d;
+            for (int n = 0; n < 4; ++n)
+                if (at(x + dx[n], y + dy[n]) == '.')
+                    reach(q, x + dx[n], y + dy[n], l, d + 1);
+            auto w = warp.find({ x, y });
+            if (w == warp.end())
+                continue;
+            int to = !levels ? 0 : (*w).second.outer_ ? l - 1 : l + 1;
+            if (to >= 0 && to <= max_level)
+                reach(q, (*w).second.x_, (*w).second.y_, to, d + 1);
+        }
+        return -1;
+    };
+    return { search(false), search(true) };
+}
 
-    return d[nv - 1];
+// a snapshot of an edge store is the portal ids and the edges, so loading
+// one skips the arena and all the bfs.
+//
+constexpr std::uint32_t snapshot_kind {201920};
+constexpr std::uint32_t snapshot_version {1};
 
+void save_snapshot(edge_store const& es, char const* fn)
+{
+    aoc::snapshot_writer w(snapshot_kind, snapshot_version);
+    w.add(es.ids_);
+    w.add(es.edges_);
+    w.save(fn);
 }
 
-int main()
+edge_store_view view(aoc::snapshot const& s)
 {
-    std::cout << "Reading input\n";
-    auto a = get_arena();
-    print_vertices(a);
-    auto es = build_edge_store(a);
-    print_edge_store(es);
-    std::cout << "part 1 = " << pt1(es) << '\n';
-    std::cout << "part 2 = " << pt2(es) << '\n';
+    edge_store_view v { s.section<int>(0), s.section<edge_store_t>(1) };
+    for (auto& e : v.edges_)
+        if (e.f_ < 0 || e.t_ < 0 || e.f_ >= 2 * v.size() || e.t_ >= 2 * v.size())
+            throw std::runtime_error("snapshot edge out of range");
+    return v;
+}
+
+}
+
+#if defined(AOC_RUNNER)
+#include <runner/runner.h>
+
+// the edge store is built as the input is loaded, and both parts search it.
+//
+AOC_RUNNER_ENTRY(aoc2019_20, "2019-20",
+    [](aoc::input const& in){ return build_edge_store(get_arena(in));},
+    [](edge_store const& es){ return std::to_string(pt1(view(es), false).dist_);},
+    [](edge_store const& es){ return std::to_string(pt2(view(es), 10000).dist_);})
+#endif
+
+#if !defined(AOC_BENCH) && !defined(AOC_RUNNER)
+#include <common/instrument_alloc.h>
+
+using namespace aoc2019_20;
+
+// usage : aoc2019_20 [--verbose] [--route] [--compare] [--check] [--max-level N] [--save-snapshot file] [--load-snapshot file] [input file]
+//
+// --verbose dumps the vertices, edge store and part 1 graph, --route prints
+// the shortest route for each part. --save-snapshot writes the edge store
+// out, --load-snapshot uses one in place of an input. each reports the time
+// to get to a usable edge store. --check solves both parts again with a
+// plain bfs over the characters.
+//
+int main(int ac, char* av[])
+{
+    bool cmp { false };
+    bool chk { false };
+    bool verbose { false };
+    bool route { false };
+    int max_level { 10000 };
+    char const* save { nullptr };
+    char const* load { nullptr };
+    char const* fn { nullptr };
+    for (int n = 1; n < ac; ++n)
+    {
+        std::string_view arg { av[n] };
+        if (arg == "--compare")
+            cmp = true;
+        else
+        if (arg == "--check")
+            chk = true;
+        else
+        if (arg == "--verbose")
+            verbose = true;
+        else
+        if (arg == "--route")
+            route = true;
+        else
+        if (arg == "--max-level" && n + 1 < ac)
+            max_level = std::stoi(av[++n]);
+        else
+        if (arg == "--save-snapshot" && n + 1 < ac)
+            save = av[++n];
+        else
+        if (arg == "--load-snapshot" && n + 1 < ac)
+            load = av[++n];
+        else
+            fn = av[n];
+    }
+    if (cmp)
+    {
+        std::cout << "Reading input\n";
+        auto in = fn ? aoc::input(fn) : aoc::input();
+        auto a = get_arena(in);
+        std::cout << "sx = " << a.sx_ << ", sy = " << a.sy_ << '\n';
+        compare(a, get_char_arena(in));
+        return 0;
+    }
+    if (chk)
+    {
+        auto in = fn ? aoc::input(fn) : aoc::input();
+        auto [c1, c2] = aoc::timed("check", [&]{ return check(in, max_level);});
+        std::cout << "part 1 (check) = " << c1 << '\n';
+        std::cout << "part 2 (check) = " << c2 << '\n';
+        return 0;
+    }
+    edge_store built;
+    std::optional<aoc::snapshot> snap;
+    auto start = [&]
+    {
+        if (load)
+        {
+            snap.emplace(load, snapshot_kind, snapshot_version);
+            return view(*snap);
+        }
+        std::cout << "Reading input\n";
+        auto in = fn ? aoc::input(fn) : aoc::input();
+        auto a = get_arena(in);
+        std::cout << "sx = " << a.sx_ << ", sy = " << a.sy_ << '\n';
+        if (verbose)
+            print_vertices(a);
+        built = build_edge_store(a);
+        return view(built);
+    };
+    // a missing input or a bad snapshot is reported as the runner reports a
+    // failed job.
+    edge_store_view es;
+    try
+    {
+        es = save || load ? aoc::timed(load ? "warm start" : "cold start", start) : start();
+        if (save && !load)
+            save_snapshot(built, save);
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "error : " << e.what() << '\n';
+        return 1;
+    }
+    if (verbose)
+        print_edge_store(es);
+    auto p1 = pt1(es, verbose);
+    std::cout << "part 1 = " << p1.dist_ << '\n';
+    if (route)
+        print_route(es, p1.route_);
+    auto p2 = pt2(es, max_level);
+    std::cout << "part 2 = " << p2.dist_ << " (max level " << p2.max_level_ << ", " << p2.expanded_ << " states expanded)\n";
+    if (route)
+        print_route(es, p2.route_);
 }
+#endif
@@ -2,79 +2,107 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <set>
-#include <queue>
 #include <numeric>
+#include <optional>
+#include <string_view>
 
-using graph_t = std::map<std::string, std::vector<std::string>>;
+#include <common/input.h>
+#include <common/instrument.h>
 
-void add_edge(std::string const& from, std::string const& to, graph_t& g)
+// the orbits form a tree rooted at COM, so each body need only know the
+// body it orbits.
+//
+using graph_t = std::map<std::string, std::string>;
+
+void add_edge(std::string_view from, std::string_view to, graph_t& g)
 {
-    g[from].push_back(to);
-    g[to].push_back(from);
+    g[std::string(to)] = from;
 }
 
-graph_t get_input()
+// parsing builds the map as it goes, so the two are timed as one.
+//
+graph_t get_input(aoc::input const& in)
 {
+    AOC_TIMED("parse, build");
     graph_t g;
-    std::string ln;
-    while(std::getline(std::cin, ln))
+    for(auto ln : aoc::lines(in.text()))
     {
-        auto p = ln.find(')');
-        add_edge(ln.substr(0, p), ln.substr(p + 1), g);
+        auto from = aoc::next_field(ln, ')');
+        add_edge(from, ln, g);
     }
+    AOC_COUNT("bodies", g.size());
     return g;
 }
 
 void print_graph(graph_t const& g)
 {
     for(auto& r : g)
-    {
-        std::cout << r.first << " : " ;
-        for(auto& v : r.second)
-            std::cout << v << ' ';
-        std::cout << '\n';
-    }
+        std::cout << r.first << " ) " << r.second << '\n';
     std::cout << '\n';
 }
 
-auto bfs(std::string const& src, graph_t const& g)
+// number of direct and indirect orbits of u. walks up until it meets a body
+// whose depth is known, or COM, then fills in the way back, so every orbit is
+// followed once and a long chain doesn't run out of stack.
+//
+size_t depth(std::string const& u, graph_t const& g, std::map<std::string, size_t>& d)
 {
-    std::map<std::string, size_t> distances;
-    std::queue<std::string>       q;
-    q.push(src);
-    distances[src] = 0;
-    while( !q.empty())
+    std::vector<std::string const*> path;
+    size_t rv {0};
+    for(auto v = &u; ; )
     {
-        auto u = q.front(); q.pop();
-        for(auto& v : g.at(u))
+        if( auto it = d.find(*v); it != d.end())
         {
-            if( !distances.contains(v))
-            {
-                distances[v] = distances[u] + 1;
-                q.push(v);
-            }
+            rv = (*it).second;
+            break;
         }
+        auto p = g.find(*v);
+        if( p == g.end())
+            break;
+        path.push_back(v);
+        v = &(*p).second;
     }
-    return distances;
+    for(; !path.empty(); path.pop_back())
+        d[*path.back()] = ++rv;
+    return rv;
 }
 
 size_t pt1(graph_t const& g)
 {
-    auto d = bfs("COM", g);
-    return std::accumulate(d.begin(), d.end(), 0, [](auto s, auto& v){  return s + v.second;});
+    AOC_TIMED("depths");
+    std::map<std::string, size_t> d;
+    return std::accumulate(g.begin(), g.end(), size_t{0}, [&](auto s, auto& v){  return s + depth(v.first, g, d);});
 }
 
-size_t pt2(graph_t const& g)
+// mark the bodies on the way from YOU to COM with their distance, then walk
+// from SAN until one of them is met. nothing if YOU or SAN is missing, or
+// they don't share a body.
+//
+std::optional<size_t> pt2(graph_t const& g)
 {
-    auto d = bfs("YOU", g);
-    return d["SAN"] - 2;
+    AOC_TIMED("transfers");
+    std::map<std::string, size_t> you;
+    size_t n {0};
+    for(auto u = g.find("YOU"); u != g.end(); u = g.find((*u).second))
+        you[(*u).second] = n++;
+    n = 0;
+    for(auto u = g.find("SAN"); u != g.end(); u = g.find((*u).second))
+    {
+        if( you.contains((*u).second))
+            return n + you[(*u).second];
+        ++n;
+    }
+    return std::nullopt;
 }
 
-int main()
+#include <common/instrument_alloc.h>
+
+int main(int ac, char* av[])
 {
-    auto g = get_input();
+    auto in = ac > 1 ? aoc::input(av[1]) : aoc::input();
+    auto g = get_input(in);
     print_graph(g);
     std::cout << "pt1 = " << pt1(g) << '\n';    
-    std::cout << "pt2 = " << pt2(g) << '\n';    
+    auto p2 = pt2(g);
+    std::cout << "pt2 = " << (p2 ? std::to_string(*p2) : "no YOU/SAN") << '\n';
 }
\ No newline at end of file
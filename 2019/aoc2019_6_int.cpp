@@ -1,86 +1,542 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <map>
-#include <queue>
 #include <numeric>
+#include <string_view>
+#include <span>
+#include <cstdint>
+#include <stdexcept>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <optional>
 
-size_t id_from_name(std::string const& name)
+#include <common/input.h>
+#include <common/graph.h>
+#include <common/snapshot.h>
+#include <common/instrument.h>
+#include <common/generate.h>
+
+namespace aoc2019_6
+{
+
+// names are up to 12 of [0-9A-Z] packed base 37, so that no name packs to 0.
+//
+constexpr int name_base {37};
+constexpr size_t max_name {12};
+
+std::uint64_t name_key(std::string_view name)
 {
-    static std::map<std::string, size_t> ids_;
-    auto[it, b] = ids_.try_emplace(name, ids_.size());
-    return (*it).second;
+    if( name.empty() || name.size() > max_name)
+        throw std::invalid_argument("bad name \"" + std::string(name) + '\"');
+    std::uint64_t k {0};
+    for(auto c : name)
+    {
+        int d;
+        if( c >= '0' && c <= '9')
+            d = c - '0' + 1;
+        else
+        if( c >= 'A' && c <= 'Z')
+            d = c - 'A' + 11;
+        else
+            throw std::invalid_argument("bad name \"" + std::string(name) + '\"');
+        k = k * name_base + d;
+    }
+    return k;
 }
 
-using graph_t = std::vector<std::vector<int>>;
+std::string name_from_key(std::uint64_t k)
+{
+    std::string rv;
+    for(; k; k /= name_base)
+    {
+        int d = k % name_base;
+        rv.insert(rv.begin(), d <= 10 ? char('0' + d - 1) : char('A' + d - 11));
+    }
+    return rv;
+}
 
-void add_vertex(size_t id, graph_t& g)
+// interns names as dense ids. puzzle names are at most 3 characters, so their
+// keys index a table of 37^3 directly. longer names, as in generated maps, go
+// into an open addressed table.
+//
+class name_table
 {
-    while ( g.size() <= id)
-        g.push_back({});
+    static constexpr std::uint64_t direct_size = name_base * name_base * name_base;
+    static constexpr std::uint32_t none = ~std::uint32_t{0};
+    struct slot_t
+    {
+        std::uint64_t key_;
+        std::uint32_t id_;
+    };
+    std::vector<std::uint32_t> direct_;
+    std::vector<slot_t>        hashed_; // key_ 0 is an empty slot
+    std::vector<std::uint64_t> keys_;   // by id
+
+    size_t slot(std::uint64_t k) const
+    {
+        auto mask = hashed_.size() - 1;
+        auto s = (k * 0x9e3779b97f4a7c15) >> 20 & mask;
+        while( hashed_[s].key_ != 0 && hashed_[s].key_ != k)
+            s = (s + 1) & mask;
+        return s;
+    }
+    void grow()
+    {
+        std::vector<slot_t> old(std::max<size_t>(hashed_.size() * 2, 1024));
+        old.swap(hashed_);
+        for(auto& e : old)
+            if( e.key_)
+                hashed_[slot(e.key_)] = e;
+    }
+public:
+    name_table() : direct_(direct_size, none)
+    {}
+    std::uint32_t intern(std::string_view name)
+    {
+        auto k = name_key(name);
+        if( k < direct_size)
+        {
+            if( direct_[k] == none)
+            {
+                direct_[k] = keys_.size();
+                keys_.push_back(k);
+            }
+            return direct_[k];
+        }
+        if( (keys_.size() + 1) * 2 > hashed_.size())
+            grow();
+        auto& e = hashed_[slot(k)];
+        if( e.key_ == 0)
+        {
+            e = { k, std::uint32_t(keys_.size())};
+            keys_.push_back(k);
+        }
+        return e.id_;
+    }
+    // the id of a name, or size() if it isn't present.
+    //
+    size_t find(std::string_view name) const
+    {
+        auto k = name_key(name);
+        if( k < direct_size)
+            return direct_[k] == none ? size() : direct_[k];
+        if( hashed_.empty())
+            return size();
+        auto& e = hashed_[slot(k)];
+        return e.key_ == 0 ? size() : e.id_;
+    }
+    std::string name(size_t id) const
+    {
+        return name_from_key(keys_[id]);
+    }
+    size_t size() const
+    {
+        return keys_.size();
+    }
+    std::span<const std::uint64_t> keys() const
+    {
+        return keys_;
+    }
+};
+
+// compressed sparse row adjacency over body ids.
+//
+using graph_t = aoc::csr_graph<std::uint32_t>;
+
+constexpr std::uint32_t no_body = ~std::uint32_t{0};
+
+// the orbits form a tree rooted at COM, so each body need only know the one
+// it orbits. parent_[id] is no_body for COM.
+//
+struct orbit_map
+{
+    name_table                 names_;
+    std::vector<std::uint32_t> parent_;
+};
+
+// what the solvers need of an orbit map, either one just parsed or one used
+// in place from a snapshot. a snapshot has no name_table, instead the ids in
+// order of their keys, searched by bisection.
+//
+struct orbit_view
+{
+    std::span<const std::uint32_t> parent_;
+    std::span<const std::uint64_t> keys_;   // by id
+    std::span<const std::uint32_t> by_key_; // from a snapshot
+    name_table const*              names_ {nullptr};
+
+    size_t size() const
+    {
+        return parent_.size();
+    }
+    // the id of a name, or size() if it isn't present.
+    //
+    size_t find(std::string_view name) const
+    {
+        if( names_)
+            return names_->find(name);
+        auto k = name_key(name);
+        auto i = std::lower_bound(by_key_.begin(), by_key_.end(), k, [&](auto id, auto key){ return keys_[id] < key;});
+        return i == by_key_.end() || keys_[*i] != k ? size() : *i;
+    }
+};
+
+orbit_view view(orbit_map const& om)
+{
+    return { om.parent_, om.names_.keys(), {}, &om.names_ };
 }
 
-void add_edge(size_t from, size_t to, graph_t& g)
+// a name that can't be packed is reported with its line number.
+//
+orbit_map get_input(std::string_view txt)
+{
+    AOC_TIMED("parse");
+    orbit_map om;
+    size_t n {0};
+    for(auto ln : aoc::lines(txt))
+    {
+        ++n;
+        try
+        {
+            auto id_from = om.names_.intern(aoc::next_field(ln, ')'));
+            auto id_to   = om.names_.intern(ln);
+            om.parent_.resize(om.names_.size(), no_body);
+            om.parent_[id_to] = id_from;
+        }
+        catch( std::invalid_argument const& e)
+        {
+            throw std::invalid_argument("line " + std::to_string(n) + " : " + e.what());
+        }
+    }
+    return om;
+}
+
+// the orbits as an undirected graph, as a check on the tree code, with
+// each orbit an edge in both directions.
+//
+graph_t build_graph(orbit_view const& om)
+{
+    AOC_TIMED("build_graph");
+    return aoc::make_csr<std::uint32_t>(om.parent_.size(), [&](auto add)
+        {
+            for(std::uint32_t v = 0; v < om.parent_.size(); ++v)
+                if( om.parent_[v] != no_body)
+                {
+                    add(v, om.parent_[v]);
+                    add(om.parent_[v], v);
+                }
+        });
+}
+
+using aoc::bfs_mode;
+
+// distances from id_from over the orbits both ways, aoc::unreached<size_t>
+// for bodies it can't reach.
+//
+std::vector<size_t> bfs(size_t id_from, graph_t const& g, bfs_mode mode = bfs_mode::top_down)
 {
-    add_vertex(from, g);
-    add_vertex(to, g);
-    g[from].push_back(to);
+    aoc::dense_distances<size_t> d(g.size());
+    aoc::bfs(g, std::uint32_t(id_from), d, mode);
+    return std::move(d).distances();
 }
 
-graph_t get_input()
+// number of direct and indirect orbits of every body. each body walks up
+// until it meets one whose depth is known, then fills in the way back, so
+// every orbit is followed once.
+//
+std::vector<std::uint32_t> depths(std::span<const std::uint32_t> parent)
 {
-    graph_t g;
-    std::string ln;
-    while(std::getline(std::cin, ln))
+    AOC_TIMED("depths");
+    std::vector<std::uint32_t> d(parent.size(), no_body);
+    std::vector<std::uint32_t> path;
+    for(std::uint32_t v = 0; v < parent.size(); ++v)
     {
-        auto p = ln.find(')');
-        auto id_from = id_from_name(ln.substr(0, p));
-        auto id_to   = id_from_name(ln.substr(p + 1));
-        add_edge(id_from, id_to, g);
-        add_edge(id_to, id_from, g);
+        auto u = v;
+        while( d[u] == no_body && parent[u] != no_body)
+        {
+            path.push_back(u);
+            u = parent[u];
+        }
+        if( d[u] == no_body)
+            d[u] = 0;
+        for(; !path.empty(); path.pop_back())
+            d[path.back()] = d[parent[path.back()]] + 1;
     }
-    return g;
+    return d;
 }
 
-std::vector<size_t> bfs(size_t id_from, graph_t const& g)
+// binary lifting, up_[k][v] is the 2^k th body out from v towards COM
+// (COM for any beyond it), so a common ancestor is found in log steps.
+//
+class lca_table
 {
-    std::vector<size_t> distances (g.size());
-    std::vector<bool>   visited(g.size());
-    std::queue<size_t> q;
-    q.push(id_from);
-    while( !q.empty())
+    std::vector<std::vector<std::uint32_t>> up_;
+    std::vector<std::uint32_t>              depth_;
+public:
+    explicit lca_table(std::span<const std::uint32_t> parent) : depth_{depths(parent)}
     {
-        auto u = q.front(); q.pop();
-        visited[u] = true;
-        for(auto v : g[u])
+        AOC_TIMED("lca_table");
+        auto max_depth = depth_.empty() ? 0 : *std::max_element(depth_.begin(), depth_.end());
+        up_.emplace_back(parent.size());
+        for(std::uint32_t v = 0; v < parent.size(); ++v)
+            up_[0][v] = parent[v] == no_body ? v : parent[v];
+        for(size_t k = 1; (std::uint64_t{1} << k) <= max_depth; ++k)
         {
-            if( !visited[v])
+            auto& prev = up_[k - 1];
+            std::vector<std::uint32_t> next(parent.size());
+            for(size_t v = 0; v < parent.size(); ++v)
+                next[v] = prev[prev[v]];
+            up_.push_back(std::move(next));
+        }
+    }
+    std::uint32_t lca(std::uint32_t a, std::uint32_t b) const
+    {
+        if( depth_[a] < depth_[b])
+            std::swap(a, b);
+        for(size_t k = up_.size(); k-- > 0; )
+            if( depth_[a] - depth_[b] >= (std::uint64_t{1} << k))
+                a = up_[k][a];
+        if( a == b)
+            return a;
+        for(size_t k = up_.size(); k-- > 0; )
+            if( up_[k][a] != up_[k][b])
             {
-                distances[v]= distances[u] + 1;
-                q.push(v);
+                a = up_[k][a];
+                b = up_[k][b];
             }
-        }
+        return up_[0][a];
+    }
+    size_t distance(std::uint32_t a, std::uint32_t b) const
+    {
+        return depth_[a] + depth_[b] - 2 * depth_[lca(a, b)];
     }
-    return distances;
+};
+
+size_t pt1(orbit_view const& om)
+{
+    auto d = depths(om.parent_);
+    return std::accumulate(d.begin(), d.end(), size_t{0});
+}
+
+// whether id, from find(), is a body that orbits another.
+//
+bool in_orbit(orbit_view const& om, size_t id)
+{
+    return id < om.size() && om.parent_[id] != no_body;
+}
+
+// transfers needed to move from the body a orbits to the body b orbits,
+// both in_orbit.
+//
+size_t transfers(orbit_view const& om, lca_table const& lt, std::uint32_t a, std::uint32_t b)
+{
+    return lt.distance(om.parent_[a], om.parent_[b]);
+}
+
+// nothing if YOU or SAN isn't there to move between, as in the part 1
+// example.
+//
+std::optional<size_t> pt2(orbit_view const& om)
+{
+    auto you = om.find("YOU");
+    auto san = om.find("SAN");
+    if( !in_orbit(om, you) || !in_orbit(om, san))
+        return std::nullopt;
+    lca_table lt(om.parent_);
+    return transfers(om, lt, you, san);
 }
 
-size_t pt1(graph_t const& g)
+std::string pt2_text(std::optional<size_t> p2)
 {
-    auto d = bfs(id_from_name("COM"), g);
-    return std::accumulate(d.begin(), d.end(), 0);
+    return p2 ? std::to_string(*p2) : "no YOU/SAN";
 }
 
-size_t pt2(graph_t const& g)
+// check pt1 and pt2 with a bfs over the whole graph, both ways.
+//
+void check(orbit_view const& om)
 {
-    auto d = bfs(id_from_name("YOU"), g);
-    return d[id_from_name("SAN")] - 2;
+    auto com = om.find("COM");
+    auto you = om.find("YOU");
+    auto san = om.find("SAN");
+    if( com == om.size())
+    {
+        std::cout << "no COM\n";
+        return;
+    }
+    auto g = build_graph(om);
+    for(auto mode : { bfs_mode::top_down, bfs_mode::direction_optimising})
+    {
+        auto nm = mode == bfs_mode::top_down ? "top down" : "direction optimising";
+        auto d  = aoc::timed(nm, [&]{ return bfs(com, g, mode);});
+        std::cout << "pt1 (bfs) = " << std::accumulate(d.begin(), d.end(), size_t{0}) << '\n';
+        if( in_orbit(om, you) && in_orbit(om, san))
+            std::cout << "pt2 (bfs) = " << bfs(you, g, mode)[san] - 2 << '\n';
+        else
+            std::cout << "pt2 (bfs) = no YOU/SAN\n";
+    }
 }
 
-int main()
+// answer "A B" lines, the transfers between the bodies A and B orbit.
+//
+void queries(orbit_view const& om, char const* fn)
 {
-    auto g = get_input();
-    auto p1 = pt1(g);
-    auto p2 = pt2(g);
-    std::cout << "pt1 = " << p1 << '\n';    
-    std::cout << "pt2 = " << p2 << '\n';    
-}
\ No newline at end of file
+    lca_table lt(om.parent_);
+    aoc::input qin(fn);
+    for(auto ln : aoc::lines(qin.text()))
+    {
+        auto a = aoc::next_field(ln, ' ');
+        auto ia = om.find(a);
+        auto ib = om.find(ln);
+        std::cout << a << ' ' << ln << ' ';
+        if( !in_orbit(om, ia) || !in_orbit(om, ib))
+            std::cout << "-\n";
+        else
+            std::cout << transfers(om, lt, ia, ib) << '\n';
+    }
+}
+
+// times each step on a random map of n bodies, the same as
+// 'aoc_generate --seed 2019 orbits n' writes.
+//
+void bench(size_t n)
+{
+    auto txt = aoc::generate::orbits(n, 2019);
+    std::cout << n << " bodies, " << txt.size() / (1024 * 1024) << "MB\n";
+    auto om = aoc::timed("input", [&]{ return get_input(txt);});
+    auto p1 = aoc::timed("pt1  ", [&]{ return pt1(view(om));});
+    auto p2 = aoc::timed("pt2  ", [&]{ return pt2(view(om));});
+    std::cout << "pt1 = " << p1 << '\n';
+    std::cout << "pt2 = " << pt2_text(p2) << '\n';
+    auto lt = aoc::timed("lca table", [&]{ return lca_table(om.parent_);});
+    constexpr size_t nq {100000};
+    auto sum = aoc::timed("100000 queries", [&]
+        {
+            std::mt19937 gen(6);
+            std::uniform_int_distribution<std::uint32_t> body(0, om.parent_.size() - 1);
+            size_t rv {0};
+            for(size_t q = 0; q < nq; ++q)
+                rv += lt.distance(body(gen), body(gen));
+            return rv;
+        });
+    std::cout << "mean distance = " << double(sum) / nq << '\n';
+    check(view(om));
+}
+
+// a snapshot of an orbit map is its parent array, the name keys by id and
+// the ids in key order.
+//
+constexpr std::uint32_t snapshot_kind {201906};
+constexpr std::uint32_t snapshot_version {1};
+
+void save_snapshot(orbit_map const& om, char const* fn)
+{
+    auto keys = om.names_.keys();
+    std::vector<std::uint32_t> by_key(keys.size());
+    std::iota(by_key.begin(), by_key.end(), 0);
+    std::sort(by_key.begin(), by_key.end(), [&](auto a, auto b){ return keys[a] < keys[b];});
+    aoc::snapshot_writer w(snapshot_kind, snapshot_version);
+    w.add(om.parent_);
+    w.add(keys);
+    w.add(by_key);
+    w.save(fn);
+}
+
+orbit_view view(aoc::snapshot const& s)
+{
+    orbit_view v { s.section<std::uint32_t>(0), s.section<std::uint64_t>(1), s.section<std::uint32_t>(2) };
+    if( v.keys_.size() != v.size() || v.by_key_.size() != v.size())
+        throw std::runtime_error("snapshot sections disagree");
+    return v;
+}
+
+}
+
+#if defined(AOC_RUNNER)
+#include <runner/runner.h>
+
+AOC_RUNNER_ENTRY(aoc2019_6, "2019-06",
+    [](aoc::input const& in){ return get_input(in.text());},
+    [](orbit_map const& om){ return std::to_string(pt1(view(om)));},
+    [](orbit_map const& om){ return pt2_text(pt2(view(om)));})
+#endif
+
+#if !defined(AOC_BENCH) && !defined(AOC_RUNNER)
+#include <common/instrument_alloc.h>
+
+using namespace aoc2019_6;
+
+// usage : aoc2019_6_int [--bench N] [--check] [--queries file] [--save-snapshot file] [--load-snapshot file] [input file]
+//
+// --save-snapshot writes the parsed orbit map out, --load-snapshot uses one in
+// place of an input. each reports the time to get to a usable map.
+//
+int main(int ac, char* av[])
+{
+    if( ac > 2 && std::string_view(av[1]) == "--bench")
+    {
+        bench(std::stoul(av[2]));
+        return 0;
+    }
+    bool chk { false};
+    char const* qfn { nullptr};
+    char const* save { nullptr};
+    char const* load { nullptr};
+    char const* fn { nullptr};
+    for(int n = 1; n < ac; ++n)
+    {
+        std::string_view arg { av[n]};
+        if( arg == "--check")
+            chk = true;
+        else
+        if( arg == "--queries" && n + 1 < ac)
+            qfn = av[++n];
+        else
+        if( arg == "--save-snapshot" && n + 1 < ac)
+            save = av[++n];
+        else
+        if( arg == "--load-snapshot" && n + 1 < ac)
+            load = av[++n];
+        else
+            fn = av[n];
+    }
+    orbit_map                    parsed;
+    std::optional<aoc::snapshot> snap;
+    auto start = [&]
+        {
+            if( load)
+            {
+                snap.emplace(load, snapshot_kind, snapshot_version);
+                return view(*snap);
+            }
+            auto in = fn ? aoc::input(fn) : aoc::input();
+            parsed  = get_input(in.text());
+            return view(parsed);
+        };
+    // a missing input, a bad name or a bad snapshot is reported as the runner
+    // reports a failed job.
+    orbit_view om;
+    try
+    {
+        om = save || load ? aoc::timed(load ? "warm start" : "cold start", start) : start();
+        if( save && !load)
+            save_snapshot(parsed, save);
+    }
+    catch( std::exception const& e)
+    {
+        std::cerr << "error : " << e.what() << '\n';
+        return 1;
+    }
+    if( qfn)
+    {
+        queries(om, qfn);
+        return 0;
+    }
+    auto p1 = pt1(om);
+    auto p2 = pt2(om);
+    std::cout << "pt1 = " << p1 << '\n';
+    std::cout << "pt2 = " << pt2_text(p2) << '\n';
+    if( chk)
+        check(om);
+}
+#endif
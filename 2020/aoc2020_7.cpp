@@ -1,103 +1,784 @@
 #include <iostream>
-#include <map>
-#include <set>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <string_view>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <bit>
+#include <charconv>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <span>
 #include <numeric>
+#include <optional>
+#include <memory_resource>
+#include <map>
+#include <set>
+#include <queue>
+#include <sstream>
 
 #include <single-header/ctre.hpp>
 
+#include <common/input.h>
+#include <common/graph.h>
+#include <common/snapshot.h>
+#include <common/arena.h>
+#include <common/instrument.h>
+
+namespace aoc2020_7
+{
+
 constexpr auto ln_rx = ctll::fixed_string{ R"(([a-z ]+) bags contain ([^\.]*)\.)" };
 constexpr auto bg_rx = ctll::fixed_string{ R"((\d+) ([a-z]+ [a-z]+))" };
 
-struct edge_t
+struct id_edge_t
 {
-    std::string colour_;
-    int         cnt_;
+    int to_;
+    int cnt_;
 };
 
-using graph_t = std::map<std::string, std::vector<edge_t>>;
+// the edges of each colour, compressed (CSR).
+//
+using csr_t      = aoc::csr_graph<id_edge_t, int>;
+using csr_view_t = aoc::csr_view<id_edge_t, int>;
 
-graph_t make_graph()
+// hash string views and strings alike, so names can be looked up from
+// views into the input without making a string.
+//
+struct name_hash
 {
-    graph_t g;
-    std::string ln;
-    while (std::getline(std::cin, ln))
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const
+    {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+// the rules over colour ids, numbered as the colours are first seen.
+// contains_ holds the bags each colour contains and contained_by_ the
+// colours each is contained by, both made once after parsing.
+//
+// the names and their map, a node and maybe a string for every colour, come
+// from 'r', which can be an arena to drop them all at once. the csr arrays
+// are two allocations each whatever the size, and stay on the heap.
+//
+struct rule_graph
+{
+    std::pmr::vector<std::pmr::string> names_;
+    std::pmr::unordered_map<std::pmr::string, int, name_hash, std::equal_to<>> ids_;
+    csr_t contains_;
+    csr_t contained_by_;
+    explicit rule_graph(std::pmr::memory_resource* r = std::pmr::get_default_resource()) : names_(r), ids_(r)
+    {}
+    int intern(std::string_view nm)
+    {
+        if (auto it = ids_.find(nm); it != ids_.end())
+            return (*it).second;
+        ids_.emplace(nm, int(names_.size()));
+        names_.emplace_back(nm);
+        return int(names_.size()) - 1;
+    }
+    int find(std::string_view nm) const
+    {
+        auto it = ids_.find(nm);
+        return it == ids_.end() ? -1 : (*it).second;
+    }
+};
+
+struct rule_t
+{
+    int from_;
+    int to_;
+    int cnt_;
+};
+
+// both directions from the one list of rules, by counting sort.
+//
+void make_csr(std::vector<rule_t> const& rules, rule_graph& g)
+{
+    AOC_TIMED("make_csr");
+    AOC_COUNT("rules", rules.size());
+    auto nc = g.names_.size();
+    g.contains_ = aoc::make_csr<id_edge_t, int>(nc, [&](auto add)
+        {
+            for (auto& r : rules)
+                add(r.from_, { r.to_, r.cnt_ });
+        });
+    g.contained_by_ = aoc::make_csr<id_edge_t, int>(nc, [&](auto add)
+        {
+            for (auto& r : rules)
+                add(r.to_, { r.from_, r.cnt_ });
+        });
+}
+
+// the rules made with a string for every capture, kept to compare against.
+//
+rule_graph make_graph_strings(aoc::input const& in)
+{
+    AOC_TIMED("parse, strings");
+    rule_graph g;
+    std::vector<rule_t> rules;
+    for (auto ln : aoc::lines(in.text()))
     {
         if (auto [m, b, c] = ctre::match<ln_rx>(ln); m)
         {
-            auto to = b.to_string();
+            auto to = g.intern(b.to_string());
             for (auto m : ctre::range<bg_rx>(c.to_view()))
             {
                 auto cnt  = std::stoi(m.get<1>().to_string());
-                auto from = m.get<2>().to_string();
-                g[to].emplace_back(edge_t{from, cnt});
-                g.try_emplace(from);
+                auto from = g.intern(m.get<2>().to_string());
+                rules.push_back({to, from, cnt});
             }
         }
         else
             std::cout << "Line \"" << ln << "\" failed to parse.\n";
     }
+    make_csr(rules, g);
     return g;
 }
 
-graph_t reverse_graph(graph_t const& g)
+// the names seen by one thread, as views into the input.
+//
+struct chunk_names
+{
+    std::vector<std::string_view>             names_;
+    std::unordered_map<std::string_view, int> ids_;
+    int intern(std::string_view nm)
+    {
+        auto [it, b] = ids_.try_emplace(nm, int(names_.size()));
+        if (b)
+            names_.push_back(nm);
+        return (*it).second;
+    }
+};
+
+struct parsed_rules
+{
+    std::vector<rule_t>           rules_;
+    std::vector<std::string_view> failed_;
+};
+
+// every capture stays a view into the input, counts are read in place and
+// names interned straight from the views.
+//
+template<typename N> parsed_rules parse_rules(std::string_view txt, N& names)
 {
-    graph_t go;
-    for(auto al : g)
+    parsed_rules pr;
+    for (auto ln : aoc::lines(txt))
     {
-        for( auto& f : al.second)
-            go[f.colour_].emplace_back(edge_t{al.first, f.cnt_});
-        go.try_emplace(al.first);
+        if (auto [m, b, c] = ctre::match<ln_rx>(ln); m)
+        {
+            auto to = names.intern(b.to_view());
+            for (auto m : ctre::range<bg_rx>(c.to_view()))
+            {
+                auto cv = m.get<1>().to_view();
+                int cnt { 0 };
+                std::from_chars(cv.data(), cv.data() + cv.size(), cnt);
+                pr.rules_.push_back({to, names.intern(m.get<2>().to_view()), cnt});
+            }
+        }
+        else
+            pr.failed_.push_back(ln);
     }
-    return go;
+    return pr;
 }
 
-void dump_graph(graph_t const& g)
+// with more than one thread the input is cut into a chunk per thread at line
+// ends, each parsed with its own names. the chunks are then merged in order,
+// which numbers the colours just as a single pass would.
+//
+rule_graph make_graph(aoc::input const& in, int threads = 1, std::pmr::memory_resource* r = std::pmr::get_default_resource())
 {
-    for(auto p : g)
+    AOC_TIMED("parse");
+    rule_graph g(r);
+    auto txt = in.text();
+    if (threads <= 1)
+    {
+        auto pr = parse_rules(txt, g);
+        for (auto ln : pr.failed_)
+            std::cout << "Line \"" << ln << "\" failed to parse.\n";
+        make_csr(pr.rules_, g);
+        return g;
+    }
+    std::vector<std::string_view> chunks;
+    while (!txt.empty())
+    {
+        auto e = std::min(txt.size(), txt.size() / (threads - chunks.size()) + 1);
+        e = txt.find('\n', e - 1);
+        e = e == std::string_view::npos ? txt.size() : e + 1;
+        chunks.push_back(txt.substr(0, e));
+        txt.remove_prefix(e);
+    }
+    std::vector<chunk_names>  names(chunks.size());
+    std::vector<parsed_rules> parsed(chunks.size());
     {
-        std::cout << '\"' << p.first << "\" :";
-        for(auto b : p.second)
-            std::cout << " \"" << b.colour_ << "\" (" << b.cnt_ << ')';
+        std::vector<std::jthread> workers;
+        for (size_t n = 0; n < chunks.size(); ++n)
+            workers.emplace_back([&, n]{ parsed[n] = parse_rules(chunks[n], names[n]);});
+    }
+    std::vector<rule_t> rules;
+    for (size_t n = 0; n < chunks.size(); ++n)
+    {
+        std::vector<int> id(names[n].names_.size());
+        for (size_t i = 0; i < id.size(); ++i)
+            id[i] = g.intern(names[n].names_[i]);
+        for (auto& r : parsed[n].rules_)
+            rules.push_back({id[r.from_], id[r.to_], r.cnt_});
+        for (auto ln : parsed[n].failed_)
+            std::cout << "Line \"" << ln << "\" failed to parse.\n";
+    }
+    make_csr(rules, g);
+    return g;
+}
+
+// what the solvers need of the rules, either just parsed or used in place
+// from a snapshot. a snapshot has no rule_graph, instead the names end to end
+// with where each starts, and the ids in name order, searched by bisection.
+//
+struct rule_view
+{
+    csr_view_t            contains_;
+    csr_view_t            contained_by_;
+    std::span<const char> chars_;
+    std::span<const int>  name_offsets_; // name id is [name_offsets_[id], name_offsets_[id + 1])
+    std::span<const int>  by_name_;
+    rule_graph const*     g_ { nullptr };
+
+    int size() const
+    {
+        return int(contains_.size());
+    }
+    std::string_view name(int id) const
+    {
+        if (g_)
+            return g_->names_[id];
+        return { chars_.data() + name_offsets_[id], size_t(name_offsets_[id + 1] - name_offsets_[id]) };
+    }
+    int find(std::string_view nm) const
+    {
+        if (g_)
+            return g_->find(nm);
+        auto it = std::lower_bound(by_name_.begin(), by_name_.end(), nm, [&](int id, std::string_view n){ return name(id) < n;});
+        return it == by_name_.end() || name(*it) != nm ? -1 : *it;
+    }
+};
+
+rule_view view(rule_graph const& g)
+{
+    return { g.contains_.view(), g.contained_by_.view(), {}, {}, {}, &g };
+}
+
+// each colour and the colours that can directly contain it.
+//
+void dump_graph(rule_view const& g)
+{
+    for (int u = 0; u < g.size(); ++u)
+    {
+        std::cout << '\"' << g.name(u) << "\" :";
+        for (auto& e : g.contained_by_[u])
+            std::cout << " \"" << g.name(e.to_) << "\" (" << e.cnt_ << ')';
         std::cout << '\n';
     }
 }
 
-void pt1_worker(std::string const& u, graph_t const& g, std::set<std::string>& cc)
+// a store for aoc::bfs that only marks colours as seen, and counts them.
+//
+struct seen_store
 {
-    for(auto& v : g.at(u))
+    using weight_type = int;
+    aoc::bitset seen_;
+    int         cnt_ { 0 };
+    int get(int v) const
+    {
+        return seen_.test(v) ? 0 : aoc::unreached<int>;
+    }
+    void set(int v, int, int)
     {
-        cc.insert(v.colour_);        
-        pt1_worker(v.colour_, g, cc );
+        seen_.set(v);
+        ++cnt_;
     }
+};
+
+// the number of colours reachable from 'from', not counting itself.
+//
+int reachable(csr_view_t const& adj, int from)
+{
+    seen_store s { aoc::bitset(adj.size()) };
+    aoc::bfs(adj, from, s);
+    return s.cnt_ - 1;
 }
 
-int pt1(graph_t const& g)
+int pt1(rule_view const& g)
 {
-    std::set<std::string> collect_colours;
-    pt1_worker("shiny gold", g, collect_colours);
-    return collect_colours.size();
+    auto id = g.find("shiny gold");
+    return id == -1 ? 0 : reachable(g.contained_by_, id);
 }
 
-int pt2_worker(std::string const& u, graph_t const& g)
+// every colour after all those it leads to. empty if there's a cycle.
+//
+std::vector<int> post_order(rule_view const& g, csr_view_t const& adj)
 {
-    int rv { 1 };
-    for(auto& v : g.at(u))
-        rv += v.cnt_ * pt2_worker(v.colour_, g);
-    return rv;
+    int nc = adj.size();
+    std::vector<int> order;
+    order.reserve(nc);
+    std::vector<char> state(nc, 0); // 0 unseen, 1 on the stack, 2 done
+    std::vector<std::pair<int, size_t>> stk; // colour, next edge
+    for (int r = 0; r < nc; ++r)
+    {
+        if (state[r])
+            continue;
+        stk.push_back({r, 0});
+        state[r] = 1;
+        while (!stk.empty())
+        {
+            auto& [u, e] = stk.back();
+            if (e < adj[u].size())
+            {
+                auto v = adj[u][e++].to_;
+                if (state[v] == 1)
+                {
+                    std::cout << "Rules have a cycle through \"" << g.name(v) << "\".\n";
+                    return {};
+                }
+                if (state[v] == 0)
+                {
+                    state[v] = 1;
+                    stk.push_back({v, 0});
+                }
+                continue;
+            }
+            order.push_back(u);
+            state[u] = 2;
+            stk.pop_back();
+        }
+    }
+    return order;
 }
 
-int pt2(graph_t const& g)
+// which colours can eventually contain each colour, as a row of bits per
+// colour, n^2 / 8 bytes in all. a colour is done after all its containers,
+// so its row is theirs or'd together along with their own bits. afterwards
+// any 'can a contain b' or 'how many can contain b' is a lookup.
+//
+struct containers_t
 {
-    return pt2_worker("shiny gold", g) - 1;
+    size_t words_;
+    std::vector<std::uint64_t> bits_;
+    std::vector<int> cnt_;
+    bool can_contain(int outer, int inner) const
+    {
+        return bits_[inner * words_ + (outer >> 6)] >> (outer & 63) & 1;
+    }
+};
+
+containers_t containers(rule_view const& g)
+{
+    AOC_TIMED("containers");
+    containers_t c;
+    size_t nc = g.size();
+    auto order = post_order(g, g.contained_by_);
+    if (nc && order.empty())
+        return c;
+    c.words_ = (nc + 63) / 64;
+    c.bits_.resize(nc * c.words_);
+    c.cnt_.resize(nc);
+    for (auto u : order)
+    {
+        auto row = c.bits_.begin() + u * c.words_;
+        for (auto& v : g.contained_by_[u])
+        {
+            auto vrow = c.bits_.begin() + v.to_ * c.words_;
+            for (size_t w = 0; w < c.words_; ++w)
+                row[w] |= vrow[w];
+            row[v.to_ >> 6] |= std::uint64_t{1} << (v.to_ & 63);
+        }
+        for (size_t w = 0; w < c.words_; ++w)
+            c.cnt_[u] += std::popcount(row[w]);
+    }
+    return c;
 }
 
-int main()
+// each line of the file is either a colour, for how many colours can contain
+// it, or "outer colour, inner colour" for whether the one can contain the
+// other.
+//
+void containers_queries(rule_view const& g, char const* fn)
 {
-    auto g = make_graph();
-    dump_graph(reverse_graph(g));
-    std::cout << "p1 = " << pt1(reverse_graph(g)) << '\n';
-    std::cout << "p2 = " << pt2(g) << '\n';
+    auto c = containers(g);
+    if (c.bits_.empty())
+        return;
+    aoc::input qin(fn);
+    for (auto ln : aoc::lines(qin.text()))
+    {
+        if (ln.empty())
+            continue;
+        std::cout << ln << " : ";
+        auto inner = ln;
+        auto outer = aoc::next_field(inner, ',');
+        if (inner.starts_with(' '))
+            inner.remove_prefix(1);
+        auto o = g.find(outer);
+        auto i = g.find(inner);
+        if (o == -1 || (!inner.empty() && i == -1))
+            std::cout << "unknown";
+        else
+        if (inner.empty())
+            std::cout << c.cnt_[o];
+        else
+            std::cout << (c.can_contain(o, i) ? "yes" : "no");
+        std::cout << '\n';
+    }
+}
+
+// counts saturate rather than wrap.
+//
+constexpr std::uint64_t count_overflow = std::numeric_limits<std::uint64_t>::max();
+
+std::uint64_t add_count(std::uint64_t a, std::uint64_t b)
+{
+    return a > count_overflow - b ? count_overflow : a + b;
+}
+
+std::uint64_t mul_count(std::uint64_t a, std::uint64_t b)
+{
+    return b != 0 && a > count_overflow / b ? count_overflow : a * b;
+}
+
+// the number of bags inside each colour. every colour is done after all
+// those it contains, so each is summed once from already known counts.
+// empty if the rules have a cycle.
+//
+std::vector<std::uint64_t> contents(rule_view const& g)
+{
+    AOC_TIMED("contents");
+    auto order = post_order(g, g.contains_);
+    if (order.empty())
+        return {};
+    std::vector<std::uint64_t> cnt(g.size());
+    for (auto u : order)
+    {
+        std::uint64_t c { 0 };
+        for (auto& v : g.contains_[u])
+            c = add_count(c, mul_count(v.cnt_, add_count(cnt[v.to_], 1)));
+        cnt[u] = c;
+    }
+    return cnt;
+}
+
+void print_count(std::uint64_t c)
+{
+    if (c == count_overflow)
+        std::cout << "overflow";
+    else
+        std::cout << c;
+}
+
+std::uint64_t pt2(rule_view const& g)
+{
+    auto cnt = contents(g);
+    auto id = g.find("shiny gold");
+    return cnt.empty() || id == -1 ? 0 : cnt[id];
+}
+
+// the contents of every colour named in a file, one per line.
+//
+void contents_queries(rule_view const& g, char const* fn)
+{
+    auto cnt = contents(g);
+    if (cnt.empty())
+        return;
+    aoc::input qin(fn);
+    for (auto ln : aoc::lines(qin.text()))
+    {
+        if (ln.empty())
+            continue;
+        std::cout << ln << " : ";
+        if (auto id = g.find(ln); id == -1)
+            std::cout << "unknown";
+        else
+            print_count(cnt[id]);
+        std::cout << '\n';
+    }
+}
+
+bool same_graph(rule_graph const& l, rule_graph const& r)
+{
+    auto same_csr = [](csr_t const& a, csr_t const& b)
+    {
+        return a.offsets_ == b.offsets_ &&
+               std::equal(a.edges_.begin(), a.edges_.end(), b.edges_.begin(), b.edges_.end(),
+                          [](auto& x, auto& y){ return x.to_ == y.to_ && x.cnt_ == y.cnt_;});
+    };
+    return l.names_ == r.names_ && same_csr(l.contains_, r.contains_) && same_csr(l.contained_by_, r.contained_by_);
+}
+
+// parse the input with strings, with views, and with views on several
+// threads, and check they agree.
+//
+void bench_parse(aoc::input const& in, int threads)
+{
+    size_t lines { 0 };
+    for ([[maybe_unused]] auto ln : aoc::lines(in.text()))
+        ++lines;
+    auto g1 = aoc::timed("strings        ", [&]{ return make_graph_strings(in);}, lines, "lines");
+    auto g2 = aoc::timed("views          ", [&]{ return make_graph(in);}, lines, "lines");
+    auto g3 = aoc::timed("views, threaded", [&]{ return make_graph(in, threads);}, lines, "lines");
+    std::cout << lines << " lines, " << threads << " threads, " <<
+        (same_graph(g1, g2) && same_graph(g1, g3) ? "same\n" : "DIFFERENT\n");
+}
+
+// both parts again the plain way, as a check on all of the above. the rules
+// are read a word at a time into maps keyed by name, part 1 is a bfs over
+// the colours that contain each and part 2 a memoised recursion, a cycle
+// counting as 0 as it does in pt2.
+//
+std::pair<int, std::uint64_t> check(aoc::input const& in)
+{
+    std::map<std::string, std::vector<std::pair<int, std::string>>> contains;
+    std::map<std::string, std::vector<std::string>> contained_by;
+    std::istringstream is { std::string(in.text()) };
+    std::string ln;
+    while (std::getline(is, ln))
+    {
+        std::istringstream ls { ln };
+        std::string a, b, w;
+        if (!(ls >> a >> b))
+            continue;
+        auto outer = a + ' ' + b;
+        ls >> w >> w; // bags contain
+        auto& inner = contains[outer];
+        while (ls >> w && w != "no")
+        {
+            int n = std::stoi(w);
+            ls >> a >> b >> w; // ... bag, or bags.
+            inner.push_back({ n, a + ' ' + b });
+            contained_by[a + ' ' + b].push_back(outer);
+        }
+    }
+
+    std::set<std::string> seen;
+    std::queue<std::string> q;
+    q.push("shiny gold");
+    while (!q.empty())
+    {
+        for (auto& c : contained_by[q.front()])
+            if (seen.insert(c).second)
+                q.push(c);
+        q.pop();
+    }
+
+    std::map<std::string, std::uint64_t> memo;
+    std::set<std::string> open;
+    bool cycle { false };
+    std::function<std::uint64_t(std::string const&)> inside = [&](std::string const& c) -> std::uint64_t
+    {
+        if (auto it = memo.find(c); it != memo.end())
+            return (*it).second;
+        if (!open.insert(c).second)
+        {
+            cycle = true;
+            return 0;
+        }
+        std::uint64_t rv { 0 };
+        for (auto& [n, d] : contains[c])
+            rv = add_count(rv, mul_count(n, add_count(inside(d), 1)));
+        open.erase(c);
+        return memo[c] = rv;
+    };
+    auto p2 = contains.count("shiny gold") ? inside("shiny gold") : 0;
+    return { int(seen.size()), cycle ? 0 : p2 };
+}
+
+// a snapshot of the rules is both csr graphs and the name table.
+//
+constexpr std::uint32_t snapshot_kind { 202007 };
+constexpr std::uint32_t snapshot_version { 1 };
+
+void save_snapshot(rule_graph const& g, char const* fn)
+{
+    std::vector<char> chars;
+    std::vector<int>  offsets { 0 };
+    for (auto& nm : g.names_)
+    {
+        chars.insert(chars.end(), nm.begin(), nm.end());
+        offsets.push_back(int(chars.size()));
+    }
+    std::vector<int> by_name(g.names_.size());
+    std::iota(by_name.begin(), by_name.end(), 0);
+    std::sort(by_name.begin(), by_name.end(), [&](int l, int r){ return g.names_[l] < g.names_[r];});
+    aoc::snapshot_writer w(snapshot_kind, snapshot_version);
+    w.add(g.contains_.offsets_);
+    w.add(g.contains_.edges_);
+    w.add(g.contained_by_.offsets_);
+    w.add(g.contained_by_.edges_);
+    w.add(chars);
+    w.add(offsets);
+    w.add(by_name);
+    w.save(fn);
+}
+
+rule_view view(aoc::snapshot const& s)
+{
+    rule_view v { { s.section<int>(0), s.section<id_edge_t>(1) },
+                  { s.section<int>(2), s.section<id_edge_t>(3) },
+                  s.section<char>(4), s.section<int>(5), s.section<int>(6) };
+    auto nc = v.by_name_.size();
+    auto good_csr = [&](csr_view_t const& c)
+    {
+        return c.offsets_.size() == nc + 1 && c.offsets_.front() == 0 && size_t(c.offsets_.back()) == c.edges_.size() &&
+               std::is_sorted(c.offsets_.begin(), c.offsets_.end()) &&
+               std::all_of(c.edges_.begin(), c.edges_.end(), [&](auto& e){ return e.to_ >= 0 && size_t(e.to_) < nc;});
+    };
+    if (!good_csr(v.contains_) || !good_csr(v.contained_by_) || v.name_offsets_.size() != nc + 1 ||
+        v.name_offsets_.front() != 0 || size_t(v.name_offsets_.back()) != v.chars_.size() ||
+        !std::is_sorted(v.name_offsets_.begin(), v.name_offsets_.end()) ||
+        !std::all_of(v.by_name_.begin(), v.by_name_.end(), [&](int id){ return id >= 0 && size_t(id) < nc;}))
+        throw std::runtime_error("snapshot sections disagree");
+    return v;
+}
+
+}
+
+#if defined(AOC_RUNNER)
+#include <runner/runner.h>
+
+AOC_RUNNER_ENTRY(aoc2020_7, "2020-07",
+    [](aoc::input const& in){ return make_graph(in);},
+    [](rule_graph const& g){ return std::to_string(pt1(view(g)));},
+    [](rule_graph const& g)
+    {
+        auto c = pt2(view(g));
+        return c == count_overflow ? std::string("overflow") : std::to_string(c);
+    })
+#endif
+
+#if !defined(AOC_BENCH) && !defined(AOC_RUNNER)
+#include <common/instrument_alloc.h>
+
+using namespace aoc2020_7;
+
+// usage : aoc2020_7 [--dump] [--contents file] [--can-contain file] [--threads N] [--bench-parse] [--check]
+//                  [--save-snapshot file] [--load-snapshot file] [--arena] [input file]
+//
+// --dump prints each colour and the colours that can directly contain it.
+// --contents prints the number of bags inside each colour listed in the file,
+// --can-contain answers containment queries, see containers_queries.
+// --threads parses the input in that many chunks at once, --bench-parse
+// compares the parsers, --check solves both parts again the plain way.
+// --save-snapshot writes the parsed rules out, --load-snapshot uses them in
+// place of an input. each reports the time to get to usable rules. --arena
+// keeps the names on an arena.
+//
+int main(int ac, char* av[])
+{
+    char const* fn { nullptr };
+    char const* qfn { nullptr };
+    char const* cfn { nullptr };
+    char const* save { nullptr };
+    char const* load { nullptr };
+    bool dump { false };
+    bool bench { false };
+    bool chk { false };
+    bool use_arena { false };
+    int threads { 1 };
+    for (int n = 1; n < ac; ++n)
+    {
+        std::string_view arg { av[n] };
+        if (arg == "--contents" && n + 1 < ac)
+            qfn = av[++n];
+        else
+        if (arg == "--can-contain" && n + 1 < ac)
+            cfn = av[++n];
+        else
+        if (arg == "--dump")
+            dump = true;
+        else
+        if (arg == "--threads" && n + 1 < ac)
+            threads = std::stoi(av[++n]);
+        else
+        if (arg == "--bench-parse")
+            bench = true;
+        else
+        if (arg == "--check")
+            chk = true;
+        else
+        if (arg == "--save-snapshot" && n + 1 < ac)
+            save = av[++n];
+        else
+        if (arg == "--load-snapshot" && n + 1 < ac)
+            load = av[++n];
+        else
+        if (arg == "--arena")
+            use_arena = true;
+        else
+            fn = av[n];
+    }
+    if (bench)
+    {
+        auto in = fn ? aoc::input(fn) : aoc::input();
+        bench_parse(in, threads > 1 ? threads : std::max(2u, std::thread::hardware_concurrency()));
+        return 0;
+    }
+    if (chk)
+    {
+        auto in = fn ? aoc::input(fn) : aoc::input();
+        auto [c1, c2] = aoc::timed("check", [&]{ return check(in);});
+        std::cout << "p1 (check) = " << c1 << '\n';
+        std::cout << "p2 (check) = ";
+        print_count(c2);
+        std::cout << '\n';
+        return 0;
+    }
+    // built on the same resource as make_graph's result, so assigning that
+    // moves it rather than copying.
+    aoc::arena a;
+    auto r = use_arena ? static_cast<std::pmr::memory_resource*>(&a) : std::pmr::get_default_resource();
+    rule_graph built(r);
+    std::optional<aoc::snapshot> snap;
+    auto start = [&]
+    {
+        if (load)
+        {
+            snap.emplace(load, snapshot_kind, snapshot_version);
+            return view(*snap);
+        }
+        auto in = fn ? aoc::input(fn) : aoc::input();
+        built = make_graph(in, threads, r);
+        return view(built);
+    };
+    // a missing input or a bad snapshot is reported as the runner reports a
+    // failed job.
+    rule_view g;
+    try
+    {
+        g = save || load ? aoc::timed(load ? "warm start" : "cold start", start) : start();
+        if (save && !load)
+            save_snapshot(built, save);
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "error : " << e.what() << '\n';
+        return 1;
+    }
+    if (dump)
+        dump_graph(g);
+    if (qfn)
+    {
+        contents_queries(g, qfn);
+        return 0;
+    }
+    if (cfn)
+    {
+        containers_queries(g, cfn);
+        return 0;
+    }
+    std::cout << "p1 = " << pt1(g) << '\n';
+    std::cout << "p2 = ";
+    print_count(pt2(g));
+    std::cout << '\n';
 }
+#endif
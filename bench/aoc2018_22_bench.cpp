@@ -0,0 +1,73 @@
+#define AOC_BENCH
+#include <2018/aoc2018_22.cpp>
+#include <common/instrument_alloc.h>
+
+using namespace aoc2018_22;
+
+#include "harness.h"
+
+// the cave at targets of growing size, at the puzzle's depth. size is the
+// target's y, x is a tenth of it, as the puzzle targets are tall and thin.
+//
+pt synthetic_target(int size)
+{
+    return { size / 10, size };
+}
+
+// usage : aoc2018_22_bench [--json file] [--filter text] [--min-time seconds] [--max-size n]
+//
+int main(int ac, char* av[])
+{
+    std::vector<std::string_view> args;
+    aoc::bench::harness h(ac, av, args);
+    for(int size : { 1000, 10000, 100000 })
+    {
+        auto t = synthetic_target(size);
+        for(auto m : { storage::levels, storage::types })
+            h.run(m == storage::levels ? "erosion fill, levels" : "erosion fill, types", size, [&]
+                {
+                    cave_system cs { t, depth, m };
+                    cs.fill({t.x_ + search_margin, t.y_ + search_margin}, 1);
+                    return cs.type(t);
+                });
+        h.run("pt1", size, [&]{ return pt1(t, depth, storage::types, 1);});
+    }
+    // the explicit graph's edge lists on the heap, on an arena made for each
+    // build, and on one arena reset and reused from build to build.
+    //
+    for(int size : { 100, 300, 1000 })
+    {
+        auto t = synthetic_target(size);
+        aoc::arena reused;
+        h.run("build_graph", size, [&]{ return build_graph(t, depth, storage::types, 1).rect_.size();});
+        h.run("build_graph, arena", size, [&]
+            {
+                aoc::arena a;
+                return build_graph(t, depth, storage::types, 1, &a).rect_.size();
+            });
+        h.run("build_graph, arena reused", size, [&]
+            {
+                auto n = build_graph(t, depth, storage::types, 1, &reused).rect_.size();
+                reused.reset();
+                return n;
+            });
+        for(auto e : { engine::heap, engine::pairing, engine::bucket })
+            for(bool implicit : { false, true })
+                for(bool astar : { false, true })
+                {
+                    std::string nm = std::string("dijkstra, ") + (e == engine::heap ? "heap" : e == engine::pairing ? "pairing" : "bucket") +
+                                     (implicit ? ", implicit" : ", explicit") + (astar ? ", A*" : "");
+                    options o;
+                    o.engine_   = e;
+                    o.implicit_ = implicit;
+                    o.astar_    = astar;
+                    o.threads_  = 1;
+                    h.run(nm, size, [&]{ return pt2(t, depth, o).dist_;});
+                    if( !implicit)
+                    {
+                        o.arena_ = &reused;
+                        h.run(nm + ", arena reused", size, [&]{ return pt2(t, depth, o).dist_;});
+                    }
+                }
+    }
+}
@@ -0,0 +1,50 @@
+#define AOC_BENCH
+#include <2019/aoc2019_20.cpp>
+#include <common/instrument_alloc.h>
+
+using namespace aoc2019_20;
+
+#include <fstream>
+#include <filesystem>
+
+#include <common/generate.h>
+
+#include "harness.h"
+
+// the maze written out, as the solver reads a file.
+//
+std::filesystem::path synthetic_maze(int size, double walls)
+{
+    auto p = std::filesystem::temp_directory_path() / ("aoc2019_20_bench_" + std::to_string(size) + ".txt");
+    std::ofstream(p, std::ios::binary) << aoc::generate::donut_maze(size, size / 4, walls, 2019);
+    return p;
+}
+
+// usage : aoc2019_20_bench [--walls density] [--json file] [--filter text] [--min-time seconds] [--max-size n]
+//
+int main(int ac, char* av[])
+{
+    std::vector<std::string_view> args;
+    aoc::bench::harness h(ac, av, args);
+    double walls { 0.3 };
+    for(size_t n = 0; n + 1 < args.size(); ++n)
+        if( args[n] == "--walls")
+            walls = std::stod(std::string(args[n + 1]));
+    for(int size : { 101, 201, 401 })
+    {
+        if( !h.wanted(size))
+            continue;
+        auto p  = synthetic_maze(size, walls);
+        auto in = aoc::input(p.string().c_str());
+        auto a  = get_arena(in);
+        auto es = build_edge_store(a);
+        auto ev = view(es);
+        h.run("get_arena", size, [&]{ return get_arena(in).vertices_.size();});
+        h.run("bfs", size, [&]{ return bfs(a, a.vertices_.front().outer_).size();});
+        h.run("build_edge_store", size, [&]{ return build_edge_store(a).edges_.size();});
+        h.run("build_edge_store_sweep", size, [&]{ return build_edge_store_sweep(a).edges_.size();});
+        h.run("pt1", size, [&]{ return pt1(ev, false).dist_;});
+        h.run("pt2", size, [&]{ return pt2(ev, 10000).dist_;});
+        std::filesystem::remove(p);
+    }
+}
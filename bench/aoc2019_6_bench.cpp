@@ -0,0 +1,33 @@
+#define AOC_BENCH
+#include <2019/aoc2019_6_int.cpp>
+#include <common/instrument_alloc.h>
+
+using namespace aoc2019_6;
+
+#include <common/generate.h>
+
+#include "harness.h"
+
+// usage : aoc2019_6_bench [--json file] [--filter text] [--min-time seconds] [--max-size n]
+//
+int main(int ac, char* av[])
+{
+    std::vector<std::string_view> args;
+    aoc::bench::harness h(ac, av, args);
+    for(size_t n : { 10000, 100000, 1000000 })
+    {
+        if( !h.wanted(n))
+            continue;
+        auto txt = aoc::generate::orbits(n, 2019);
+        auto om  = get_input(txt);
+        auto g   = build_graph(view(om));
+        auto com = om.names_.find("COM");
+        h.run("get_input", n, [&]{ return get_input(txt).parent_.size();});
+        h.run("build_graph", n, [&]{ return build_graph(view(om)).edges_.size();});
+        h.run("bfs, top down", n, [&]{ return bfs(com, g, bfs_mode::top_down).size();});
+        h.run("bfs, direction optimising", n, [&]{ return bfs(com, g, bfs_mode::direction_optimising).size();});
+        h.run("pt1 (depths)", n, [&]{ return pt1(view(om));});
+        h.run("lca_table", n, [&]{ return lca_table(om.parent_).distance(0, 1);});
+        h.run("pt2", n, [&]{ return pt2(view(om)).value_or(0);});
+    }
+}
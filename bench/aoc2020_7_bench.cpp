@@ -0,0 +1,59 @@
+#define AOC_BENCH
+#include <2020/aoc2020_7.cpp>
+#include <common/instrument_alloc.h>
+
+using namespace aoc2020_7;
+
+#include <fstream>
+#include <filesystem>
+
+#include <common/generate.h>
+
+#include "harness.h"
+
+// n colours in layers of about 20, each holding up to 'fanout' from the
+// layer below, written out as the solver reads a file.
+//
+std::filesystem::path synthetic_rules(size_t n, int fanout)
+{
+    auto p = std::filesystem::temp_directory_path() / ("aoc2020_7_bench_" + std::to_string(n) + ".txt");
+    std::ofstream(p, std::ios::binary) << aoc::generate::bag_rules(n, fanout, n / 20, 2020);
+    return p;
+}
+
+// usage : aoc2020_7_bench [--json file] [--filter text] [--min-time seconds] [--max-size n]
+//
+int main(int ac, char* av[])
+{
+    std::vector<std::string_view> args;
+    aoc::bench::harness h(ac, av, args);
+    int threads = std::max(2u, std::thread::hardware_concurrency());
+    for(size_t n : { 1000, 10000, 100000 })
+    {
+        if( !h.wanted(n))
+            continue;
+        auto p  = synthetic_rules(n, 3);
+        auto in = aoc::input(p.string().c_str());
+        auto g  = make_graph(in);
+        aoc::arena reused;
+        h.run("make_graph_strings", n, [&]{ return make_graph_strings(in).names_.size();});
+        h.run("make_graph", n, [&]{ return make_graph(in).names_.size();});
+        h.run("make_graph, arena", n, [&]
+            {
+                aoc::arena a;
+                return make_graph(in, 1, &a).names_.size();
+            });
+        h.run("make_graph, arena reused", n, [&]
+            {
+                auto rv = make_graph(in, 1, &reused).names_.size();
+                reused.reset();
+                return rv;
+            });
+        h.run("make_graph, threaded", n, [&]{ return make_graph(in, threads).names_.size();});
+        h.run("reachable", n, [&]{ return reachable(g.contained_by_.view(), int(g.names_.size()) - 1);});
+        h.run("contents", n, [&]{ return contents(view(g)).size();});
+        if( n <= 10000) // n^2 bits
+            h.run("containers", n, [&]{ return containers(view(g)).cnt_.size();});
+        std::filesystem::remove(p);
+    }
+}
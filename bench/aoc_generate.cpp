@@ -0,0 +1,66 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include <common/generate.h>
+
+// usage : aoc_generate [--seed N] [-o file] what ...
+//
+//   orbits N                            2019-06, N bodies
+//   maze SIZE PORTALS [WALL_DENSITY]    2019-20, SIZE x SIZE, density 0.3 by default
+//   bags N FANOUT DEPTH                 2020-07, N colours in DEPTH layers
+//   cave SIZE                           2018-22, target SIZE / 10, SIZE
+//
+// the input goes to stdout, or the file given. the seed is 1 by default.
+//
+int main(int ac, char* av[])
+{
+    std::uint32_t seed { 1 };
+    char const* out { nullptr };
+    std::vector<std::string_view> args;
+    for( int n = 1; n < ac; ++n)
+    {
+        std::string_view arg { av[n]};
+        if( arg == "--seed" && n + 1 < ac)
+            seed = std::stoul(av[++n]);
+        else
+        if( arg == "-o" && n + 1 < ac)
+            out = av[++n];
+        else
+            args.push_back(arg);
+    }
+    auto num = [&](size_t n, double dflt = -1)
+    {
+        if( n >= args.size())
+        {
+            if( dflt < 0)
+                throw std::invalid_argument("missing argument");
+            return dflt;
+        }
+        return std::stod(std::string(args[n]));
+    };
+    std::string txt;
+    if( !args.empty() && args[0] == "orbits")
+        txt = aoc::generate::orbits(size_t(num(1)), seed);
+    else
+    if( !args.empty() && args[0] == "maze")
+        txt = aoc::generate::donut_maze(int(num(1)), int(num(2)), num(3, 0.3), seed);
+    else
+    if( !args.empty() && args[0] == "bags")
+        txt = aoc::generate::bag_rules(size_t(num(1)), int(num(2)), size_t(num(3)), seed);
+    else
+    if( !args.empty() && args[0] == "cave")
+        txt = aoc::generate::cave(int(num(1)), seed);
+    else
+    {
+        std::cout << "usage : " << av[0] << " [--seed N] [-o file] orbits N | maze SIZE PORTALS [WALL_DENSITY] | bags N FANOUT DEPTH | cave SIZE\n";
+        return 1;
+    }
+    if( out)
+        std::ofstream(out, std::ios::binary) << txt;
+    else
+        std::cout << txt;
+}
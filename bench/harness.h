@@ -0,0 +1,156 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <ctime>
+#include <cstdlib>
+#include <cstdint>
+
+#include <common/instrument.h>
+
+// a small benchmark harness. each benchmark is a name, the size of its
+// synthetic input and a function to time. the function is run until
+// --min-time seconds have passed (and at least three times), each run
+// timed on its own, and the min, median and mean kept. results print as
+// they go and, with --json file, are written in the layout of Google
+// Benchmark's JSON so the same tools can compare runs between commits.
+//
+// a benchmark including common/instrument_alloc.h also has the allocations
+// of a run reported, the fewest of any run, counting those made on the
+// harness's thread only.
+//
+// common options : [--json file] [--filter text] [--min-time seconds] [--max-size n]
+//
+namespace aoc::bench
+{
+
+template<typename T> inline void keep(T const& v)
+{
+#if defined(_MSC_VER)
+    static volatile char const* sink;
+    sink = reinterpret_cast<char const volatile*>(&v);
+#else
+    asm volatile("" : : "r,m"(v) : "memory");
+#endif
+}
+
+struct result
+{
+    std::string name_;
+    size_t      size_;
+    size_t      iterations_;
+    double      min_ns_;
+    double      median_ns_;
+    double      mean_ns_;
+    std::uint64_t allocations_;
+};
+
+class harness
+{
+    std::string         exe_;
+    std::string         json_;
+    std::string         filter_;
+    double              min_time_ { 0.5 };
+    size_t              max_size_ { ~size_t{0} };
+    std::vector<result> results_;
+
+    static std::string escape(std::string_view s)
+    {
+        std::string rv;
+        for(auto c : s)
+        {
+            if( c == '"' || c == '\\')
+                rv += '\\';
+            rv += c;
+        }
+        return rv;
+    }
+    void write_json() const
+    {
+        std::ofstream out(json_);
+        out.precision(12);
+        char date[32];
+        auto now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+        out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n    \"executable\": \"" << escape(exe_) << "\"\n  },\n";
+        out << "  \"benchmarks\": [";
+        for(size_t n = 0; n < results_.size(); ++n)
+        {
+            auto& r = results_[n];
+            out << (n ? ",\n" : "\n");
+            out << "    { \"name\": \"" << escape(r.name_) << '/' << r.size_ << "\", \"size\": " << r.size_
+                << ", \"iterations\": " << r.iterations_ << ", \"real_time\": " << r.median_ns_
+                << ", \"min_time\": " << r.min_ns_ << ", \"mean_time\": " << r.mean_ns_
+                << ", \"allocations\": " << r.allocations_ << ", \"time_unit\": \"ns\" }";
+        }
+        out << "\n  ]\n}\n";
+    }
+public:
+    // other arguments are left in args for the caller.
+    //
+    harness(int ac, char* av[], std::vector<std::string_view>& args) : exe_(av[0])
+    {
+        for(int n = 1; n < ac; ++n)
+        {
+            std::string_view arg { av[n] };
+            if( arg == "--json" && n + 1 < ac)
+                json_ = av[++n];
+            else
+            if( arg == "--filter" && n + 1 < ac)
+                filter_ = av[++n];
+            else
+            if( arg == "--min-time" && n + 1 < ac)
+                min_time_ = std::atof(av[++n]);
+            else
+            if( arg == "--max-size" && n + 1 < ac)
+                max_size_ = std::strtoull(av[++n], nullptr, 10);
+            else
+                args.push_back(arg);
+        }
+    }
+    harness(harness const&) = delete;
+    ~harness()
+    {
+        if( !json_.empty())
+            write_json();
+    }
+    // whether a benchmark of this size is to be run, so inputs for those that
+    // aren't needn't be made.
+    //
+    bool wanted(size_t size) const
+    {
+        return size <= max_size_;
+    }
+    template<typename F> void run(std::string_view name, size_t size, F f)
+    {
+        if( !wanted(size) || (!filter_.empty() && name.find(filter_) == std::string_view::npos))
+            return;
+        using clock = std::chrono::steady_clock;
+        std::vector<double> ns;
+        auto allocs = ~std::uint64_t{0};
+        auto start = clock::now();
+        do
+        {
+            auto a0 = aoc::instrument::allocations;
+            auto t0 = clock::now();
+            keep(f());
+            auto t1 = clock::now();
+            ns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+            allocs = std::min(allocs, aoc::instrument::allocations - a0);
+        } while(ns.size() < 3 || std::chrono::duration<double>(clock::now() - start).count() < min_time_);
+        std::sort(ns.begin(), ns.end());
+        result r { std::string(name), size, ns.size(), ns.front(), ns[ns.size() / 2],
+                   std::accumulate(ns.begin(), ns.end(), 0.0) / ns.size(), allocs };
+        std::cout << r.name_ << '/' << r.size_ << " : " << r.median_ns_ / 1e6 << "ms (min " << r.min_ns_ / 1e6
+                  << "ms, " << r.iterations_ << " runs, " << r.allocations_ << " allocations)\n";
+        results_.push_back(r);
+    }
+};
+
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <filesystem>
+#include <random>
+
+#include <common/input.h>
+
+// compare reading an orbit map style file, "AAA)BBB" lines split at ')',
+// with std::getline and substr against aoc::input and aoc::lines.
+//
+
+std::filesystem::path make_input(size_t mb)
+{
+    auto p = std::filesystem::temp_directory_path() / "aoc_input_bench.txt";
+    std::ofstream out(p, std::ios::binary);
+    std::mt19937 gen(2019);
+    std::uniform_int_distribution<int> c('A', 'Z');
+    std::string ln(8, '\n');
+    ln[3] = ')';
+    for(size_t n = 0; n < mb * 1024 * 1024 / ln.size(); ++n)
+    {
+        for(int i : {0, 1, 2, 4, 5, 6})
+            ln[i] = c(gen);
+        out << ln;
+    }
+    return p;
+}
+
+size_t by_getline(std::filesystem::path const& p)
+{
+    size_t rv {0};
+    std::ifstream in(p);
+    std::string ln;
+    while(std::getline(in, ln))
+    {
+        auto s = ln.find(')');
+        auto from = ln.substr(0, s);
+        auto to   = ln.substr(s + 1);
+        rv += from.size() + to.size() + from[0];
+    }
+    return rv;
+}
+
+size_t by_view(std::filesystem::path const& p)
+{
+    size_t rv {0};
+    aoc::input in(p.string().c_str());
+    for(auto ln : aoc::lines(in.text()))
+    {
+        auto from = aoc::next_field(ln, ')');
+        rv += from.size() + ln.size() + from[0];
+    }
+    return rv;
+}
+
+template<typename F> void measure(char const* what, std::filesystem::path const& p, F f)
+{
+    auto sz = std::filesystem::file_size(p);
+    auto t0 = std::chrono::steady_clock::now();
+    auto cs = f(p);
+    auto t1 = std::chrono::steady_clock::now();
+    auto s  = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << what << " : " << sz / s / (1024 * 1024) << " MB/s (" << cs << ")\n";
+}
+
+// usage : input_bench [file]
+//
+int main(int ac, char* av[])
+{
+    if( ac > 2 || (ac == 2 && std::string_view(av[1]).starts_with("--")))
+    {
+        std::cout << "usage : " << av[0] << " [file]\n";
+        return 1;
+    }
+    if( ac == 2 && !std::filesystem::is_regular_file(av[1]))
+    {
+        std::cerr << "cannot open " << av[1] << '\n';
+        return 1;
+    }
+    auto p = ac > 1 ? std::filesystem::path(av[1]) : make_input(256);
+    std::cout << p << ", " << std::filesystem::file_size(p) / (1024 * 1024) << "MB\n";
+    measure("getline   ", p, by_getline);
+    measure("aoc::input", p, by_view);
+    if( ac == 1)
+        std::filesystem::remove(p);
+}
@@ -0,0 +1,159 @@
+# cmake -P scaling.cmake, run by the 'scaling' target with the tools' paths.
+#
+# for each day, inputs of growing size from aoc_generate are solved by each
+# implementation there is and by a plain reference, a bfs or dijkstra over
+# the input as it stands, and every answer must agree. the main solver runs
+# with AOC_PROFILE_JSON set, so its phase timings at each size are kept in
+# ${OUT}/<day>_<size>.json and gathered into ${OUT}/scaling.csv.
+#
+cmake_minimum_required(VERSION 3.19.0)
+
+file(MAKE_DIRECTORY ${OUT})
+set(CSV ${OUT}/scaling.csv)
+file(WRITE ${CSV} "day,size,phase,calls,ms,bytes,allocations\n")
+
+# run a tool, failing on a non zero exit, with its output in 'var'.
+#
+function(run var)
+    execute_process(COMMAND ${ARGN} OUTPUT_VARIABLE out RESULT_VARIABLE rc)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "${ARGN} failed (${rc})")
+    endif()
+    set(${var} "${out}" PARENT_SCOPE)
+endfunction()
+
+# the first number after 'label' in 'text'.
+#
+function(answer var text label)
+    string(REGEX MATCH "${label}[ =]*(-?[0-9]+|overflow)" m "${text}")
+    if(NOT m)
+        message(FATAL_ERROR "no '${label}' in output")
+    endif()
+    set(${var} ${CMAKE_MATCH_1} PARENT_SCOPE)
+endfunction()
+
+function(agree what a b)
+    if(NOT "${a}" STREQUAL "${b}")
+        message(FATAL_ERROR "${what} : ${a} != ${b}")
+    endif()
+endfunction()
+
+# the main solver with profiling on, its timers appended to the csv.
+#
+function(profile var day size)
+    set(json ${OUT}/${day}_${size}.json)
+    run(out ${CMAKE_COMMAND} -E env AOC_PROFILE_JSON=${json} ${ARGN})
+    file(READ ${json} j)
+    string(JSON n LENGTH "${j}" timers)
+    if(n GREATER 0)
+        math(EXPR last "${n} - 1")
+        foreach(i RANGE ${last})
+            string(JSON name GET "${j}" timers ${i} name)
+            string(JSON calls GET "${j}" timers ${i} calls)
+            string(JSON ms GET "${j}" timers ${i} ms)
+            string(JSON bytes GET "${j}" timers ${i} bytes)
+            string(JSON allocs GET "${j}" timers ${i} allocations)
+            file(APPEND ${CSV} "${day},${size},\"${name}\",${calls},${ms},${bytes},${allocs}\n")
+        endforeach()
+    endif()
+    set(${var} "${out}" PARENT_SCOPE)
+endfunction()
+
+set(IN ${OUT}/inputs)
+file(MAKE_DIRECTORY ${IN})
+
+# 2019-06 : the map based solver, the integer one and its bfs check, both
+# solvers profiled.
+#
+foreach(n 1000 10000 100000 1000000)
+    set(f ${IN}/2019_6_${n}.txt)
+    run(_ ${GENERATE} -o ${f} orbits ${n})
+    profile(int 2019_6 ${n} ${AOC2019_6_INT} ${f})
+    answer(p1 "${int}" "pt1")
+    answer(p2 "${int}" "pt2")
+    run(chk ${AOC2019_6_INT} --check ${f})
+    answer(c1 "${chk}" "pt1 \\(bfs\\)")
+    answer(c2 "${chk}" "pt2 \\(bfs\\)")
+    agree("2019-06 ${n} pt1, bfs" ${p1} ${c1})
+    agree("2019-06 ${n} pt2, bfs" ${p2} ${c2})
+    if(n LESS_EQUAL 100000)
+        profile(old 2019_6_map ${n} ${AOC2019_6} ${f})
+        answer(o1 "${old}" "pt1")
+        answer(o2 "${old}" "pt2")
+        agree("2019-06 ${n} pt1, map" ${p1} ${o1})
+        agree("2019-06 ${n} pt2, map" ${p2} ${o2})
+    endif()
+    message(STATUS "2019-06 ${n} : ${p1} ${p2}")
+endforeach()
+
+# 2019-20 : the answers against the bfs over the characters, and the
+# character and bitplane layouts and both edge store builds compared.
+#
+foreach(n 51 101 201 401)
+    math(EXPR portals "${n} / 4")
+    set(f ${IN}/2019_20_${n}.txt)
+    run(_ ${GENERATE} -o ${f} maze ${n} ${portals})
+    profile(out 2019_20 ${n} ${AOC2019_20} ${f})
+    answer(p1 "${out}" "part 1")
+    answer(p2 "${out}" "part 2")
+    run(chk ${AOC2019_20} --check ${f})
+    answer(c1 "${chk}" "part 1 \\(check\\)")
+    answer(c2 "${chk}" "part 2 \\(check\\)")
+    agree("2019-20 ${n} part 1, check" ${p1} ${c1})
+    agree("2019-20 ${n} part 2, check" ${p2} ${c2})
+    run(cmp ${AOC2019_20} --compare ${f})
+    if(cmp MATCHES "DIFFERENT")
+        message(FATAL_ERROR "2019-20 ${n} : layouts or edge stores differ")
+    endif()
+    message(STATUS "2019-20 ${n} : ${p1} ${p2}")
+endforeach()
+
+# 2020-07 : one thread and four against the plain map based check, and the
+# three parsers compared. the rules are 20 layers deep at every size, so the
+# counts stay in range.
+#
+foreach(n 1000 10000 100000)
+    set(f ${IN}/2020_7_${n}.txt)
+    run(_ ${GENERATE} -o ${f} bags ${n} 3 20)
+    profile(out 2020_7 ${n} ${AOC2020_7} ${f})
+    answer(p1 "${out}" "p1")
+    answer(p2 "${out}" "p2")
+    run(thr ${AOC2020_7} --threads 4 ${f})
+    answer(t1 "${thr}" "p1")
+    answer(t2 "${thr}" "p2")
+    agree("2020-07 ${n} p1, threaded" ${p1} ${t1})
+    agree("2020-07 ${n} p2, threaded" ${p2} ${t2})
+    run(chk ${AOC2020_7} --check ${f})
+    answer(c1 "${chk}" "p1 \\(check\\)")
+    answer(c2 "${chk}" "p2 \\(check\\)")
+    agree("2020-07 ${n} p1, check" ${p1} ${c1})
+    agree("2020-07 ${n} p2, check" ${p2} ${c2})
+    run(cmp ${AOC2020_7} --bench-parse ${f})
+    if(cmp MATCHES "DIFFERENT")
+        message(FATAL_ERROR "2020-07 ${n} : parsers differ")
+    endif()
+    message(STATUS "2020-07 ${n} : ${p1} ${p2}")
+endforeach()
+
+# 2018-22 : the explicit graph on a binary heap against the implicit one with
+# A* on buckets, and both against the plain risk sum and dijkstra.
+#
+foreach(n 100 300 1000)
+    set(f ${IN}/2018_22_${n}.txt)
+    run(_ ${GENERATE} -o ${f} cave ${n})
+    profile(out 2018_22 ${n} ${AOC2018_22} heap explicit ${f})
+    answer(p1 "${out}" "pt1        ")
+    answer(p2 "${out}" "pt2        ")
+    run(alt ${AOC2018_22} bucket implicit astar check ${f})
+    answer(a1 "${alt}" "pt1        ")
+    answer(a2 "${alt}" "pt2        ")
+    answer(c1 "${alt}" "pt1 \\(check\\)")
+    answer(c2 "${alt}" "pt2 \\(check\\)")
+    agree("2018-22 ${n} pt1" ${p1} ${a1})
+    agree("2018-22 ${n} pt2" ${p2} ${a2})
+    agree("2018-22 ${n} pt1, check" ${p1} ${c1})
+    agree("2018-22 ${n} pt2, check" ${p2} ${c2})
+    message(STATUS "2018-22 ${n} : ${p1} ${p2}")
+endforeach()
+
+message(STATUS "all agree, timings in ${CSV}")
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace aoc
+{
+
+// a bump allocator for the std::pmr containers of a structure built once and
+// dropped whole, such as a graph for one solve. allocating moves a pointer
+// along the current block, freeing does nothing, and the memory goes back in
+// one go when the arena is reset, released or destroyed.
+//
+// reset() keeps the memory for the next solve, merged into one block as big
+// as all of it, so a solve repeated in the same process makes no new
+// allocations once the arena has grown to fit. release() gives it back.
+//
+// not thread safe; each thread building at once wants its own.
+//
+class arena : public std::pmr::memory_resource
+{
+    struct block
+    {
+        std::unique_ptr<std::byte[]> p_;
+        size_t                       size_;
+    };
+    std::vector<block> blocks_;
+    size_t             cur_ { 0 };   // the block being bumped
+    size_t             used_ { 0 };  // .. and how much of it is used
+    size_t             first_;       // the size of the first block
+    size_t             next_;        // .. and of the next one made
+    size_t             allocated_ { 0 };
+
+    void add_block(size_t sz)
+    {
+        blocks_.push_back({ std::make_unique_for_overwrite<std::byte[]>(sz), sz });
+    }
+    void* do_allocate(size_t bytes, size_t align) override
+    {
+        while (true)
+        {
+            if (cur_ < blocks_.size())
+            {
+                auto base = reinterpret_cast<std::uintptr_t>(blocks_[cur_].p_.get());
+                auto at   = (base + used_ + align - 1) & ~std::uintptr_t(align - 1);
+                if (at + bytes <= base + blocks_[cur_].size_)
+                {
+                    used_ = at - base + bytes;
+                    allocated_ += bytes;
+                    return reinterpret_cast<void*>(at);
+                }
+                if (cur_ + 1 < blocks_.size())
+                {
+                    ++cur_;
+                    used_ = 0;
+                    continue;
+                }
+            }
+            // blocks double, so a build makes few of them.
+            auto sz = std::max(next_, bytes + align);
+            next_ = sz * 2;
+            add_block(sz);
+            cur_  = blocks_.size() - 1;
+            used_ = 0;
+        }
+    }
+    void do_deallocate(void*, size_t, size_t) override
+    {}
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+    {
+        return this == &other;
+    }
+public:
+    explicit arena(size_t first = 64 * 1024) : first_{ first }, next_{ first }
+    {}
+    arena(arena const&) = delete;
+    arena& operator=(arena const&) = delete;
+
+    // everything allocated is forgotten and the memory kept for reuse.
+    //
+    void reset()
+    {
+        if (blocks_.size() > 1)
+        {
+            auto sz = capacity();
+            blocks_.clear();
+            add_block(sz);
+            next_ = sz * 2;
+        }
+        cur_       = 0;
+        used_      = 0;
+        allocated_ = 0;
+    }
+    // everything allocated is forgotten and the memory freed.
+    //
+    void release()
+    {
+        blocks_.clear();
+        cur_       = 0;
+        used_      = 0;
+        next_      = first_;
+        allocated_ = 0;
+    }
+    // bytes handed out since the last reset.
+    //
+    size_t allocated() const
+    {
+        return allocated_;
+    }
+    size_t capacity() const
+    {
+        size_t n { 0 };
+        for (auto& b : blocks_)
+            n += b.size_;
+        return n;
+    }
+    size_t blocks() const
+    {
+        return blocks_.size();
+    }
+};
+
+}
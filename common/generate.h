@@ -0,0 +1,173 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+
+// seeded inputs of any size for each day, as the puzzle would give them. the
+// same arguments and seed always give the same text.
+//
+namespace aoc::generate
+{
+
+// n bodies in "A)B" lines, each orbiting one already placed, so a random
+// recursive tree of depth about ln n under COM. YOU and SAN orbit two of
+// them. the lines are shuffled as in a real input.
+//
+inline std::string orbits(size_t n, std::uint32_t seed)
+{
+    std::mt19937 gen(seed);
+    auto name = [](size_t id)
+    {
+        if( id == 0)
+            return std::string("COM");
+        std::string rv;
+        for(; id; id /= 36)
+            rv += "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"[id % 36];
+        return rv + "00000"; // at least 4 characters, so never COM, YOU or SAN
+    };
+    std::vector<std::string> lns;
+    lns.reserve(n + 1);
+    for(size_t b = 1; b < n; ++b)
+        lns.push_back(name(std::uniform_int_distribution<size_t>(0, b - 1)(gen)) + ')' + name(b));
+    lns.push_back(name(std::uniform_int_distribution<size_t>(0, n - 1)(gen)) + ")YOU");
+    lns.push_back(name(std::uniform_int_distribution<size_t>(0, n - 1)(gen)) + ")SAN");
+    std::shuffle(lns.begin(), lns.end(), gen);
+    std::string rv;
+    for(auto& l : lns)
+        rv += l + '\n';
+    return rv;
+}
+
+inline std::string portal_name(int id)
+{
+    return { char('A' + id / 26), char('A' + id % 26) };
+}
+
+// a size x size donut with a ring 'size / 5' thick, walls at random with
+// density 'walls', and up to 'portals' portals besides AA and ZZ, as many as
+// fit with their names every third tile along each side.
+//
+inline std::string donut_maze(int size, int portals, double walls, std::uint32_t seed)
+{
+    std::mt19937 gen(seed);
+    std::bernoulli_distribution wall(walls);
+    std::vector<std::string> g(size, std::string(size, ' '));
+    int lo = 2, hi = size - 3;
+    int ilo = lo + size / 5, ihi = hi - size / 5;
+    for(int y = lo; y <= hi; ++y)
+        for(int x = lo; x <= hi; ++x)
+            if( x < ilo || x > ihi || y < ilo || y > ihi)
+                g[y][x] = wall(gen) ? '#' : '.';
+    auto slots = [&](int l, int h)
+    {
+        std::vector<std::pair<int, int>> rv; // side (top, bottom, left, right), position along it
+        for(int c = l + 1; c < h; c += 3)
+            for(int side = 0; side < 4; ++side)
+                rv.push_back({side, c});
+        std::shuffle(rv.begin(), rv.end(), gen);
+        return rv;
+    };
+    auto outer = slots(lo, hi);
+    auto inner = slots(ilo, ihi);
+    auto put = [&](std::pair<int, int> s, std::string const& nm, bool out)
+    {
+        auto [side, c] = s;
+        int e0 = out ? lo : ilo - 1;  // the open tile on the top or left
+        int e1 = out ? hi : ihi + 1;  // .. on the bottom or right
+        int n0 = out ? 0 : ilo;       // the name's first letter, top or left
+        int n1 = out ? size - 2 : ihi - 1;
+        switch(side)
+        {
+            case 0: g[e0][c] = '.'; g[n0][c] = nm[0]; g[n0 + 1][c] = nm[1]; break;
+            case 1: g[e1][c] = '.'; g[n1][c] = nm[0]; g[n1 + 1][c] = nm[1]; break;
+            case 2: g[c][e0] = '.'; g[c][n0] = nm[0]; g[c][n0 + 1] = nm[1]; break;
+            case 3: g[c][e1] = '.'; g[c][n1] = nm[0]; g[c][n1 + 1] = nm[1]; break;
+        }
+    };
+    std::vector<std::string> names;
+    for(int id = 1; id < 26 * 26 - 1; ++id)
+        names.push_back(portal_name(id));
+    std::shuffle(names.begin(), names.end(), gen);
+    names.resize(std::min<size_t>({names.size(), inner.size(), outer.size() - 2, size_t(std::max(portals, 0))}));
+    put(outer[0], "AA", true);
+    put(outer[1], "ZZ", true);
+    for(size_t n = 0; n < names.size(); ++n)
+    {
+        put(outer[n + 2], names[n], true);
+        put(inner[n], names[n], false);
+    }
+    std::string rv;
+    for(auto& ln : g)
+        rv += ln + '\n';
+    return rv;
+}
+
+// n colours in 'depth' layers, each colour holding up to 'fanout' others
+// from the layer below and the last layer holding none, so the rules are a
+// DAG 'depth' deep with much shared below each colour. the first of those
+// held is the colour in the same place in the layer below, so that every
+// colour is held by some colour in each layer above it. shiny gold is the
+// first colour of the middle layer, so both parts have work to do. names are
+// two words, as the puzzle's.
+//
+inline std::string bag_rules(size_t n, int fanout, size_t depth, std::uint32_t seed)
+{
+    std::mt19937 gen(seed);
+    depth = std::clamp<size_t>(depth, 1, std::max<size_t>(n, 1));
+    size_t width = (n + depth - 1) / depth;
+    size_t gold  = std::min(depth / 2 * width, n - 1);
+    auto name = [&](size_t id)
+    {
+        if( id == gold)
+            return std::string("shiny gold");
+        std::string rv { "x" };
+        for(int c = 0; c < 4; ++c, id /= 26)
+            rv += char('a' + id % 26);
+        return rv + " y" + char('a' + id % 7);
+    };
+    auto bags = [](int c){ return c == 1 ? " bag" : " bags"; };
+    std::string rv;
+    std::uniform_int_distribution<int> cnt(1, 5);
+    for(size_t c = 0; c < n; ++c)
+    {
+        rv += name(c) + " bags contain ";
+        size_t below = (c / width + 1) * width;
+        if( below >= n)
+        {
+            rv += "no other bags.\n";
+            continue;
+        }
+        std::vector<size_t> in;
+        std::uniform_int_distribution<size_t> to(below, std::min(n, below + width) - 1);
+        if( fanout > 0)
+            in.push_back(std::min(n - 1, c + width));
+        for(int f = 1; f < fanout; ++f)
+            in.push_back(to(gen));
+        std::sort(in.begin(), in.end());
+        in.erase(std::unique(in.begin(), in.end()), in.end());
+        for(size_t i = 0; i < in.size(); ++i)
+        {
+            auto k = cnt(gen);
+            rv += (i ? ", " : "") + std::to_string(k) + ' ' + name(in[i]) + bags(k);
+        }
+        rv += ".\n";
+    }
+    return rv;
+}
+
+// a cave whose target is 'size' regions down and a tenth of that across, as
+// the puzzle targets are tall and thin, at a depth in the puzzle's range.
+// the depth is a multiple of 3, as in every puzzle input, so that the mouth
+// is rocky and the torch may be held there.
+//
+inline std::string cave(int size, std::uint32_t seed)
+{
+    std::mt19937 gen(seed);
+    auto depth = std::uniform_int_distribution<int>(1000, 4000)(gen) * 3;
+    return "depth: " + std::to_string(depth) + "\ntarget: " + std::to_string(size / 10) + ',' + std::to_string(size) + '\n';
+}
+
+}
@@ -0,0 +1,661 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <queue>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <memory_resource>
+#include <type_traits>
+#include <concepts>
+#include <unordered_map>
+
+#include <common/instrument.h>
+
+namespace aoc
+{
+
+// graphs are seen by the searches through for_each_edge(g, u, f), which
+// calls f(to, weight) for each edge out of u. the graphs here provide it,
+// and a day can provide it for anything else, such as a grid or a graph
+// made as it is searched.
+//
+template<typename V, typename W> struct edge
+{
+    V to_;
+    W wt_;
+};
+
+// an edge is anything with a to_, or just the vertex it leads to. those
+// without a wt_ weigh 1.
+//
+template<typename E> auto edge_to(E const& e)
+{
+    if constexpr (requires { e.to_; })
+        return e.to_;
+    else
+        return e;
+}
+
+template<typename E> auto edge_weight(E const& e)
+{
+    if constexpr (requires { e.wt_; })
+        return e.wt_;
+    else
+        return 1;
+}
+
+// edges held per vertex, for graphs built up an edge at a time. every
+// vector, the vertices' own included, comes from one memory resource, the
+// heap by default, or an arena (common/arena.h) to make a vector per vertex
+// cheap and free them all at once. moving keeps the resource, assigning
+// copies into the target's.
+//
+template<typename V = int, typename W = int> class adjacency_list
+{
+    std::pmr::vector<std::pmr::vector<edge<V, W>>> adj_;
+public:
+    adjacency_list() = default;
+    explicit adjacency_list(size_t n, std::pmr::memory_resource* r = std::pmr::get_default_resource()) : adj_(n, r)
+    {}
+    size_t size() const
+    {
+        return adj_.size();
+    }
+    void add_edge(V from, V to, W wt)
+    {
+        adj_[from].push_back({to, wt});
+    }
+    void add_undirected_edge(V a, V b, W wt)
+    {
+        add_edge(a, b, wt);
+        add_edge(b, a, wt);
+    }
+    std::span<const edge<V, W>> operator[](size_t u) const
+    {
+        return adj_[u];
+    }
+};
+
+// a csr graph over arrays held elsewhere, such as a mapped file.
+//
+template<typename E, typename O = std::uint32_t> struct csr_view
+{
+    std::span<const O> offsets_;
+    std::span<const E> edges_;
+
+    std::span<const E> operator[](size_t u) const
+    {
+        return { edges_.data() + offsets_[u], edges_.data() + offsets_[u + 1]};
+    }
+    size_t size() const
+    {
+        return offsets_.size() - 1;
+    }
+};
+
+// edges compressed into one array, those out of u being
+// [offsets_[u], offsets_[u + 1]).
+//
+template<typename E, typename O = std::uint32_t> struct csr_graph
+{
+    std::vector<O> offsets_;
+    std::vector<E> edges_;
+
+    std::span<const E> operator[](size_t u) const
+    {
+        return { edges_.data() + offsets_[u], edges_.data() + offsets_[u + 1]};
+    }
+    size_t size() const
+    {
+        return offsets_.size() - 1;
+    }
+    csr_view<E, O> view() const
+    {
+        return { offsets_, edges_ };
+    }
+};
+
+// a csr graph of n vertices from edges(add), which calls add(from, e) for
+// every edge. it's called twice, once to count and once to place.
+//
+template<typename E, typename O = std::uint32_t, typename F> csr_graph<E, O> make_csr(size_t n, F edges)
+{
+    csr_graph<E, O> g;
+    g.offsets_.assign(n + 1, 0);
+    edges([&](size_t u, E const&){ ++g.offsets_[u + 1]; });
+    std::partial_sum(g.offsets_.begin(), g.offsets_.end(), g.offsets_.begin());
+    g.edges_.resize(g.offsets_.back());
+    std::vector<O> next(g.offsets_.begin(), g.offsets_.end() - 1);
+    edges([&](size_t u, E const& e){ g.edges_[next[u]++] = e; });
+    return g;
+}
+
+template<typename V, typename W, typename F> void for_each_edge(adjacency_list<V, W> const& g, size_t u, F f)
+{
+    for (auto& e : g[u])
+        f(e.to_, e.wt_);
+}
+
+template<typename E, typename O, typename F> void for_each_edge(csr_graph<E, O> const& g, size_t u, F f)
+{
+    for (auto& e : g[u])
+        f(edge_to(e), edge_weight(e));
+}
+
+template<typename E, typename O, typename F> void for_each_edge(csr_view<E, O> const& g, size_t u, F f)
+{
+    for (auto& e : g[u])
+        f(edge_to(e), edge_weight(e));
+}
+
+// a fixed number of bits, 64 to a word.
+//
+class bitset
+{
+    std::vector<std::uint64_t> w_;
+public:
+    explicit bitset(size_t n = 0) : w_((n + 63) / 64)
+    {}
+    bool test(size_t i) const
+    {
+        return w_[i >> 6] >> (i & 63) & 1;
+    }
+    void set(size_t i)
+    {
+        w_[i >> 6] |= std::uint64_t{1} << (i & 63);
+    }
+    void clear()
+    {
+        std::fill(w_.begin(), w_.end(), 0);
+    }
+};
+
+// the searches keep tentative distances in a store with get(v) and
+// set(v, d, from), a distance of unreached<W> meaning not yet reached.
+// the _paths stores also keep where each vertex was reached from.
+//
+template<typename W> constexpr W unreached = std::numeric_limits<W>::max();
+
+struct identity_index
+{
+    template<typename V> size_t operator()(V v) const
+    {
+        return size_t(v);
+    }
+};
+
+// a distance for every vertex, I mapping vertices to [0, n).
+//
+template<typename W, typename I = identity_index> class dense_distances
+{
+    I              index_;
+    std::vector<W> d_;
+public:
+    using weight_type = W;
+    explicit dense_distances(size_t n, I index = {}) : index_{index}, d_(n, unreached<W>)
+    {}
+    template<typename V> W get(V v) const
+    {
+        return d_[index_(v)];
+    }
+    template<typename V> void set(V v, W d, V)
+    {
+        d_[index_(v)] = d;
+    }
+    std::vector<W> const& distances() const&
+    {
+        return d_;
+    }
+    std::vector<W> distances() &&
+    {
+        return std::move(d_);
+    }
+};
+
+template<typename V, typename W, typename I = identity_index> class dense_paths
+{
+    I              index_;
+    std::vector<W> d_;
+    std::vector<V> pred_;
+public:
+    using weight_type = W;
+    explicit dense_paths(size_t n, I index = {}) : index_{index}, d_(n, unreached<W>), pred_(n)
+    {}
+    W get(V v) const
+    {
+        return d_[index_(v)];
+    }
+    void set(V v, W d, V from)
+    {
+        d_[index_(v)]    = d;
+        pred_[index_(v)] = from;
+    }
+    V pred(V v) const
+    {
+        return pred_[index_(v)];
+    }
+};
+
+// only the vertices reached are stored.
+//
+template<typename V, typename W> class sparse_distances
+{
+    std::unordered_map<V, W> d_;
+public:
+    using weight_type = W;
+    W get(V v) const
+    {
+        auto it = d_.find(v);
+        return it == d_.end() ? unreached<W> : (*it).second;
+    }
+    void set(V v, W d, V)
+    {
+        d_[v] = d;
+    }
+};
+
+template<typename V, typename W> class sparse_paths
+{
+    std::unordered_map<V, std::pair<W, V>> d_;
+public:
+    using weight_type = W;
+    W get(V v) const
+    {
+        auto it = d_.find(v);
+        return it == d_.end() ? unreached<W> : (*it).second.first;
+    }
+    void set(V v, W d, V from)
+    {
+        d_[v] = {d, from};
+    }
+    V pred(V v) const
+    {
+        return (*d_.find(v)).second.second;
+    }
+};
+
+// the vertices from 'from' to 'to' through a _paths store, which must have
+// reached 'to'. the search sets 'from' as reached from itself.
+//
+template<typename V, typename D> std::vector<V> path(D const& d, V from, V to)
+{
+    std::vector<V> p { to };
+    while (p.back() != from)
+        p.push_back(d.pred(p.back()));
+    std::reverse(p.begin(), p.end());
+    return p;
+}
+
+// a graph with a size() numbers its vertices [0, size()), as those here do.
+//
+template<typename G, typename V> concept dense_graph = std::is_integral_v<V> && requires(G const& g)
+{
+    { g.size() } -> std::convertible_to<size_t>;
+};
+
+// the number of edges out of u.
+//
+template<typename G, typename V> size_t degree(G const& g, V u)
+{
+    if constexpr (requires { g[u].size(); })
+        return g[u].size();
+    else
+    {
+        size_t n { 0 };
+        for_each_edge(g, u, [&](V, auto){ ++n;});
+        return n;
+    }
+}
+
+// whether f(v) is true for some edge u -> v, stopping at the first where the
+// graph can be indexed, as a csr graph can.
+//
+template<typename G, typename V, typename F> bool any_edge(G const& g, V u, F f)
+{
+    if constexpr (requires { g[u].begin(); })
+    {
+        for (auto& e : g[u])
+            if (f(V(edge_to(e))))
+                return true;
+        return false;
+    }
+    else
+    {
+        bool rv { false };
+        for_each_edge(g, u, [&](V v, auto){ rv = rv || f(v);});
+        return rv;
+    }
+}
+
+enum class bfs_mode { top_down, direction_optimising };
+
+// level synchronous bfs from 'from', distances in edges whatever their
+// weight. a vertex is marked as it is queued, so it is queued only once and
+// the queue is one flat array, level l occupying [head, level end). over a
+// dense_graph the marks are a bitset, elsewhere the store's distances.
+//
+// direction_optimising, for a dense_graph that is symmetric as an
+// undirected graph is, expands a level with many edges out of it, relative
+// to those not yet looked at, bottom up instead: each unmarked vertex looks
+// for a neighbour in the frontier and stops at the first.
+//
+template<typename G, typename V, typename D> void bfs(G const& g, V from, D& d, bfs_mode mode = bfs_mode::top_down)
+{
+    AOC_TIMED("bfs");
+    using W = typename D::weight_type;
+    constexpr bool dense = dense_graph<G, V>;
+    constexpr size_t alpha {14}; // bottom up when frontier edges > unexplored / alpha
+    constexpr size_t beta  {24}; // .. and the frontier holds more than size / beta
+    size_t n { 0 };
+    if constexpr (dense)
+        n = g.size();
+    bitset visited(n);
+    bitset frontier;
+    std::vector<V> q(n); // grown as it goes unless dense
+    size_t head { 0 };
+    size_t tail { 0 };
+    auto seen = [&](V v)
+    {
+        if constexpr (dense)
+            return visited.test(v);
+        else
+            return d.get(v) != unreached<W>;
+    };
+    auto reach = [&](V v, W level, V u)
+    {
+        if constexpr (dense)
+            visited.set(v);
+        d.set(v, level, u);
+        if constexpr (dense)
+            q[tail++] = v;
+        else
+        {
+            q.push_back(v);
+            ++tail;
+        }
+    };
+    size_t unexplored { 0 };
+    bool optimise { false };
+    if constexpr (dense)
+        if (mode == bfs_mode::direction_optimising)
+        {
+            optimise = true;
+            frontier = bitset(n);
+            for (size_t v = 0; v < n; ++v)
+                unexplored += degree(g, V(v));
+        }
+    size_t edges { 0 };
+    reach(from, W{0}, from);
+    for (W level = 1; head != tail; ++level)
+    {
+        size_t level_end = tail;
+        if constexpr (dense)
+            if (optimise)
+            {
+                size_t frontier_edges { 0 };
+                for (auto i = head; i < level_end; ++i)
+                    frontier_edges += degree(g, q[i]);
+                auto bottom_up = frontier_edges > unexplored / alpha && level_end - head > n / beta;
+                unexplored -= std::min(frontier_edges, unexplored);
+                if (bottom_up)
+                {
+                    frontier.clear();
+                    for (; head < level_end; ++head)
+                        frontier.set(q[head]);
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        auto v = V(i);
+                        if (!visited.test(v))
+                            any_edge(g, v, [&](V u)
+                                {
+                                    ++edges;
+                                    if (!frontier.test(u))
+                                        return false;
+                                    reach(v, level, u);
+                                    return true;
+                                });
+                    }
+                    continue;
+                }
+            }
+        for (; head < level_end; ++head)
+        {
+            auto u = q[head];
+            for_each_edge(g, u, [&](V v, auto)
+                {
+                    ++edges;
+                    if (!seen(v))
+                        reach(v, level, u);
+                });
+        }
+    }
+    AOC_COUNT("bfs vertices reached", tail);
+    AOC_COUNT("bfs edges scanned", edges);
+}
+
+// the queues for dijkstra, all with push(key, v), pop() of a least
+// (key, v) and empty(). entries are never updated, a vertex is pushed again
+// when its distance improves and the stale entries are skipped as popped.
+//
+template<typename K, typename V> class binary_heap
+{
+    using entry_t = std::pair<K, V>;
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> q_;
+public:
+    void push(K k, V v)
+    {
+        q_.push({k, v});
+    }
+    entry_t pop()
+    {
+        auto e = q_.top();
+        q_.pop();
+        return e;
+    }
+    bool empty() const
+    {
+        return q_.empty();
+    }
+};
+
+// a pairing heap in a node pool. push is O(1), pop pairs the root's children
+// left to right and then merges the pairs right to left.
+//
+template<typename K, typename V> class pairing_heap
+{
+    static constexpr std::uint32_t none = ~std::uint32_t{0};
+    struct node
+    {
+        K             k_;
+        V             v_;
+        std::uint32_t child_;
+        std::uint32_t sibling_;
+    };
+    std::vector<node>          nodes_;
+    std::vector<std::uint32_t> free_;
+    std::vector<std::uint32_t> pairs_;
+    std::uint32_t              root_ { none };
+
+    std::uint32_t meld(std::uint32_t a, std::uint32_t b)
+    {
+        if (a == none)
+            return b;
+        if (b == none)
+            return a;
+        if (nodes_[b].k_ < nodes_[a].k_)
+            std::swap(a, b);
+        nodes_[b].sibling_ = nodes_[a].child_;
+        nodes_[a].child_   = b;
+        return a;
+    }
+public:
+    void push(K k, V v)
+    {
+        std::uint32_t n;
+        if (free_.empty())
+        {
+            n = nodes_.size();
+            nodes_.push_back({k, v, none, none});
+        }
+        else
+        {
+            n = free_.back();
+            free_.pop_back();
+            nodes_[n] = {k, v, none, none};
+        }
+        root_ = meld(root_, n);
+    }
+    std::pair<K, V> pop()
+    {
+        auto r = root_;
+        std::pair<K, V> e { nodes_[r].k_, nodes_[r].v_ };
+        pairs_.clear();
+        for (auto c = nodes_[r].child_; c != none; )
+        {
+            auto a = c;
+            auto b = nodes_[a].sibling_;
+            c = b == none ? none : nodes_[b].sibling_;
+            nodes_[a].sibling_ = none;
+            if (b != none)
+                nodes_[b].sibling_ = none;
+            pairs_.push_back(meld(a, b));
+        }
+        root_ = none;
+        for (auto p = pairs_.rbegin(); p != pairs_.rend(); ++p)
+            root_ = meld(*p, root_);
+        free_.push_back(r);
+        return e;
+    }
+    bool empty() const
+    {
+        return root_ == none;
+    }
+};
+
+// Dial's buckets. keys are integers and every key pushed must lie within N
+// of the least key queued, as it will when edge weights plus the change in
+// a consistent heuristic are below N. a ring of N buckets indexed by key is
+// then enough, and pop just moves along it.
+//
+template<typename K, typename V, size_t N> class bucket_queue
+{
+    std::array<std::vector<V>, N> b_;
+    size_t queued_ { 0 };
+    K      cur_ { 0 };
+public:
+    void push(K k, V v)
+    {
+        if (queued_ == 0 || k < cur_)
+            cur_ = k;
+        b_[size_t(k) % N].push_back(v);
+        ++queued_;
+    }
+    std::pair<K, V> pop()
+    {
+        while (b_[size_t(cur_) % N].empty())
+            ++cur_;
+        auto& bk = b_[size_t(cur_) % N];
+        auto v = bk.back();
+        bk.pop_back();
+        --queued_;
+        return { cur_, v };
+    }
+    bool empty() const
+    {
+        return queued_ == 0;
+    }
+};
+
+// estimate of the remaining cost from a vertex, 0 gives plain dijkstra.
+//
+struct no_heuristic
+{
+    template<typename V> int operator()(V) const
+    {
+        return 0;
+    }
+};
+
+// 'to' is either a vertex or a predicate on vertices, for a search that
+// stops as soon as one is settled. no_target searches everything reachable.
+//
+struct no_target
+{
+    template<typename V> bool operator()(V) const
+    {
+        return false;
+    }
+};
+
+template<typename W, typename V> struct search_result
+{
+    W      dist_;     // unreached<W> if no target was reached
+    V      to_;       // the target reached
+    size_t expanded_;
+};
+
+// dijkstra, or A* with a consistent heuristic h, over queue Q.
+//
+template<typename Q, typename G, typename V, typename T, typename D, typename H = no_heuristic>
+search_result<typename D::weight_type, V> dijkstra(G const& g, V from, T to, D& d, H h = {})
+{
+    AOC_TIMED("dijkstra");
+    using W = typename D::weight_type;
+    auto is_target = [&](V u)
+    {
+        if constexpr (std::is_invocable_r_v<bool, T, V>)
+            return to(u);
+        else
+            return u == to;
+    };
+    Q q;
+    search_result<W, V> rv { unreached<W>, from, 0 };
+    size_t relaxed { 0 };
+    size_t pushes { 1 };
+    d.set(from, W{0}, from);
+    q.push(W(h(from)), from);
+    while (!q.empty())
+    {
+        auto [fu, u] = q.pop();
+        auto du = d.get(u);
+        if (fu != du + W(h(u)))
+            continue;
+        if (is_target(u))
+        {
+            rv.dist_ = du;
+            rv.to_   = u;
+            break;
+        }
+        ++rv.expanded_;
+        for_each_edge(g, u, [&](V v, auto wt)
+            {
+                W dv = du + W(wt);
+                ++relaxed;
+                if (dv < d.get(v))
+                {
+                    d.set(v, dv, u);
+                    q.push(dv + W(h(v)), v);
+                    ++pushes;
+                }
+            });
+    }
+    AOC_COUNT("dijkstra vertices settled", rv.expanded_);
+    AOC_COUNT("dijkstra edges relaxed", relaxed);
+    AOC_COUNT("dijkstra queue pushes", pushes);
+    return rv;
+}
+
+template<typename G, typename V, typename T, typename D, typename H>
+search_result<typename D::weight_type, V> astar(G const& g, V from, T to, D& d, H h)
+{
+    return dijkstra<binary_heap<typename D::weight_type, V>>(g, from, to, d, h);
+}
+
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <utility>
+#include <stdexcept>
+#include <string>
+#include <iterator>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace aoc
+{
+
+// the whole of a puzzle input, either memory mapped or, when that isn't
+// possible (a pipe, or no mmap), read in large blocks. everything handed
+// out is a view into this buffer so it must outlive them.
+//
+class input
+{
+    std::vector<char> buf_;
+    char const*       map_ {nullptr};
+    size_t            sz_ {0};
+
+    static constexpr size_t block_size = 1 << 20;
+
+    void read_blocks(std::FILE* f)
+    {
+        size_t n;
+        do
+        {
+            buf_.resize(sz_ + block_size);
+            n = std::fread(buf_.data() + sz_, 1, block_size, f);
+            sz_ += n;
+        } while (n == block_size);
+        buf_.resize(sz_);
+    }
+#if !defined(_WIN32)
+    bool map(int fd)
+    {
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+            return false;
+        auto p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+            return false;
+        ::madvise(p, st.st_size, MADV_SEQUENTIAL);
+        map_ = static_cast<char const*>(p);
+        sz_  = st.st_size;
+        return true;
+    }
+#endif
+public:
+    // stdin, mapped if it has been redirected from a file.
+    //
+    input()
+    {
+#if !defined(_WIN32)
+        if (map(STDIN_FILENO))
+            return;
+#endif
+        read_blocks(stdin);
+    }
+    explicit input(char const* path)
+    {
+#if !defined(_WIN32)
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error(std::string("cannot open ") + path);
+        bool mapped = map(fd);
+        ::close(fd);
+        if (mapped)
+            return;
+#endif
+        std::FILE* f = std::fopen(path, "rb");
+        if (!f)
+            throw std::runtime_error(std::string("cannot open ") + path);
+        read_blocks(f);
+        std::fclose(f);
+    }
+    input(input const&) = delete;
+    input& operator=(input const&) = delete;
+    input(input&& o) noexcept : buf_{std::move(o.buf_)}, map_{std::exchange(o.map_, nullptr)}, sz_{std::exchange(o.sz_, 0)}
+    {}
+    ~input()
+    {
+#if !defined(_WIN32)
+        if (map_)
+            ::munmap(const_cast<char*>(map_), sz_);
+#endif
+    }
+    std::string_view text() const
+    {
+        return { map_ ? map_ : buf_.data(), sz_ };
+    }
+};
+
+// the lines of a text, without their terminators ('\n' or "\r\n"), as
+// views. a final line without a terminator is still a line.
+//
+class lines
+{
+    std::string_view txt_;
+public:
+    class iterator
+    {
+        std::string_view rest_;
+        std::string_view ln_;
+        bool             end_ {true};
+
+        void next()
+        {
+            if (rest_.empty())
+            {
+                end_ = true;
+                return;
+            }
+            auto p = rest_.find('\n');
+            ln_    = rest_.substr(0, p);
+            rest_  = p == std::string_view::npos ? std::string_view{} : rest_.substr(p + 1);
+            if (!ln_.empty() && ln_.back() == '\r')
+                ln_.remove_suffix(1);
+        }
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = std::string_view const*;
+        using reference         = std::string_view const&;
+
+        iterator() = default;
+        explicit iterator(std::string_view txt) : rest_{txt}, end_{false}
+        {
+            next();
+        }
+        reference operator*() const
+        {
+            return ln_;
+        }
+        iterator& operator++()
+        {
+            next();
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            auto t = *this;
+            next();
+            return t;
+        }
+        bool operator==(iterator const& o) const
+        {
+            return end_ == o.end_ && (end_ || rest_.data() == o.rest_.data());
+        }
+    };
+    explicit lines(std::string_view txt) : txt_{txt}
+    {}
+    iterator begin() const
+    {
+        return iterator{txt_};
+    }
+    iterator end() const
+    {
+        return {};
+    }
+};
+
+// split a field off the front of a view at 'sep', which is consumed.
+// the whole remainder when there is no 'sep'.
+//
+inline std::string_view next_field(std::string_view& sv, char sep)
+{
+    auto p = sv.find(sep);
+    auto f = sv.substr(0, p);
+    sv     = p == std::string_view::npos ? std::string_view{} : sv.substr(p + 1);
+    return f;
+}
+
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// scoped timers and counters, reported at exit when the environment asks for
+// it: AOC_PROFILE set prints a table to stderr, AOC_PROFILE_JSON=file writes
+// the same as json. otherwise nothing is printed and the cost is a clock read
+// at each end of a timed scope and an atomic add per count.
+//
+//   AOC_TIMED("parse");            // the rest of the enclosing scope
+//   AOC_COUNT("bfs vertices", n);  // add n
+//
+// each site looks its name up once, so a name is fixed for the site.
+//
+// building with AOC_NO_INSTRUMENT removes both entirely.
+//
+// aoc::timed(what, f) is for a day's own reports: it runs f once, prints how
+// long it took and returns what f did.
+//
+// timed scopes also note the bytes allocated on their thread while they run.
+// that needs operator new counting, which a program opts in to by including
+// common/instrument_alloc.h in exactly one translation unit; without it the
+// byte counts are 0.
+//
+namespace aoc::instrument
+{
+
+inline thread_local std::uint64_t allocated_bytes { 0 };
+inline thread_local std::uint64_t allocations { 0 };
+
+struct entry
+{
+    std::string                name_;
+    bool                       timer_;
+    std::atomic<std::uint64_t> calls_ { 0 };
+    std::atomic<std::uint64_t> value_ { 0 }; // ns for a timer
+    std::atomic<std::uint64_t> bytes_ { 0 };
+    std::atomic<std::uint64_t> allocs_ { 0 };
+    entry(char const* name, bool timer) : name_{name}, timer_{timer}
+    {}
+};
+
+// every entry, in the order first reached. entries are found once per site
+// and then held by reference, so a deque keeps them where they are.
+//
+class registry
+{
+    std::mutex        m_;
+    std::deque<entry> entries_;
+
+    void print(std::FILE* f)
+    {
+        for (auto& e : entries_)
+            if (e.timer_)
+                std::fprintf(f, "%-32s %8llu calls %12.3fms %14llu bytes %10llu allocations\n", e.name_.c_str(),
+                             (unsigned long long)e.calls_, e.value_ / 1e6, (unsigned long long)e.bytes_, (unsigned long long)e.allocs_);
+        for (auto& e : entries_)
+            if (!e.timer_)
+                std::fprintf(f, "%-32s %14llu\n", e.name_.c_str(), (unsigned long long)e.value_);
+    }
+    void json(std::FILE* f)
+    {
+        auto list = [&](bool timers)
+        {
+            char const* sep = "";
+            for (auto& e : entries_)
+            {
+                if (e.timer_ != timers)
+                    continue;
+                std::fprintf(f, "%s\n    { \"name\": \"%s\", ", sep, e.name_.c_str());
+                if (timers)
+                    std::fprintf(f, "\"calls\": %llu, \"ms\": %.6f, \"bytes\": %llu, \"allocations\": %llu }",
+                                 (unsigned long long)e.calls_, e.value_ / 1e6, (unsigned long long)e.bytes_, (unsigned long long)e.allocs_);
+                else
+                    std::fprintf(f, "\"value\": %llu }", (unsigned long long)e.value_);
+                sep = ",";
+            }
+        };
+        std::fprintf(f, "{\n  \"timers\": [");
+        list(true);
+        std::fprintf(f, "\n  ],\n  \"counters\": [");
+        list(false);
+        std::fprintf(f, "\n  ]\n}\n");
+    }
+public:
+    static registry& get()
+    {
+        static registry r;
+        return r;
+    }
+    entry& find(char const* name, bool timer)
+    {
+        std::lock_guard l(m_);
+        for (auto& e : entries_)
+            if (e.name_ == name && e.timer_ == timer)
+                return e;
+        return entries_.emplace_back(name, timer);
+    }
+    ~registry()
+    {
+        if (std::getenv("AOC_PROFILE"))
+            print(stderr);
+        if (auto fn = std::getenv("AOC_PROFILE_JSON"))
+            if (auto f = std::fopen(fn, "w"))
+            {
+                json(f);
+                std::fclose(f);
+            }
+    }
+};
+
+class scoped_timer
+{
+    entry&                                e_;
+    std::chrono::steady_clock::time_point t0_;
+    std::uint64_t                         bytes0_;
+    std::uint64_t                         allocs0_;
+public:
+    explicit scoped_timer(entry& e) : e_{e}, t0_{std::chrono::steady_clock::now()}, bytes0_{allocated_bytes}, allocs0_{allocations}
+    {}
+    scoped_timer(scoped_timer const&) = delete;
+    scoped_timer& operator=(scoped_timer const&) = delete;
+    ~scoped_timer()
+    {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0_).count();
+        e_.calls_.fetch_add(1, std::memory_order_relaxed);
+        e_.value_.fetch_add(ns, std::memory_order_relaxed);
+        e_.bytes_.fetch_add(allocated_bytes - bytes0_, std::memory_order_relaxed);
+        e_.allocs_.fetch_add(allocations - allocs0_, std::memory_order_relaxed);
+    }
+};
+
+inline void count(entry& e, std::uint64_t n)
+{
+    e.calls_.fetch_add(1, std::memory_order_relaxed);
+    e.value_.fetch_add(n, std::memory_order_relaxed);
+}
+
+}
+
+namespace aoc
+{
+
+// run f once and print "what took Nms", with the rate of 'items' 'unit's a
+// second when a unit is given. the time is also kept with the timed scopes
+// under 'what', less the padding used to line reports up.
+//
+template<typename F> auto timed(char const* what, F f, std::uint64_t items = 0, char const* unit = nullptr)
+{
+#if !defined(AOC_NO_INSTRUMENT)
+    std::string_view nm { what };
+    nm = nm.substr(0, nm.find_last_not_of(' ') + 1);
+    instrument::scoped_timer st { instrument::registry::get().find(std::string(nm).c_str(), true) };
+#endif
+    auto report = [&, t0 = std::chrono::steady_clock::now()]
+    {
+        std::chrono::duration<double> s = std::chrono::steady_clock::now() - t0;
+        std::cout << what << " took " << s.count() * 1000 << "ms";
+        if (unit)
+            std::cout << ", " << std::uint64_t(items / s.count()) << ' ' << unit << "/s";
+        std::cout << '\n';
+    };
+    if constexpr (std::is_void_v<decltype(f())>)
+    {
+        f();
+        report();
+    }
+    else
+    {
+        auto rv = f();
+        report();
+        return rv;
+    }
+}
+
+}
+
+#define AOC_INSTRUMENT_CAT2(a, b) a##b
+#define AOC_INSTRUMENT_CAT(a, b) AOC_INSTRUMENT_CAT2(a, b)
+
+#if defined(AOC_NO_INSTRUMENT)
+#define AOC_TIMED(name)
+#define AOC_COUNT(name, n)
+#else
+#define AOC_TIMED(name)                                                                                               \
+    static auto& AOC_INSTRUMENT_CAT(aoc_timer_entry_, __LINE__) = aoc::instrument::registry::get().find(name, true); \
+    aoc::instrument::scoped_timer AOC_INSTRUMENT_CAT(aoc_timer_, __LINE__) { AOC_INSTRUMENT_CAT(aoc_timer_entry_, __LINE__) }
+#define AOC_COUNT(name, n)                                                                                  \
+    do                                                                                                      \
+    {                                                                                                       \
+        static auto& aoc_count_entry = aoc::instrument::registry::get().find(name, false);                  \
+        aoc::instrument::count(aoc_count_entry, n);                                                         \
+    } while (0)
+#endif
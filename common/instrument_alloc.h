@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdlib>
+#include <new>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+#include <common/instrument.h>
+
+// operator new counting for the timed scopes of common/instrument.h. these
+// replace the global allocation functions, so this is included by exactly one
+// translation unit of a program, the one with main. every one of them is kept
+// out of line, as they would be in the library: gcc takes a malloc() inlined
+// from a new, or a new[] inlined down to new, against the delete that frees it
+// for a mismatch. the aligned forms are counted too, as the std::pmr heap
+// resource allocates through them.
+//
+#if !defined(AOC_NO_INSTRUMENT)
+
+[[gnu::noinline]] void* operator new(std::size_t n)
+{
+    aoc::instrument::allocated_bytes += n;
+    ++aoc::instrument::allocations;
+    if (auto p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new[](std::size_t n)
+{
+    return operator new(n);
+}
+
+[[gnu::noinline]] void* operator new(std::size_t n, std::nothrow_t const&) noexcept
+{
+    aoc::instrument::allocated_bytes += n;
+    ++aoc::instrument::allocations;
+    return std::malloc(n ? n : 1);
+}
+
+[[gnu::noinline]] void* operator new[](std::size_t n, std::nothrow_t const& nt) noexcept
+{
+    return operator new(n, nt);
+}
+
+[[gnu::noinline]] void* operator new(std::size_t n, std::align_val_t al)
+{
+    aoc::instrument::allocated_bytes += n;
+    ++aoc::instrument::allocations;
+    auto a = static_cast<std::size_t>(al);
+#if defined(_MSC_VER)
+    if (auto p = _aligned_malloc(n ? n : 1, a))
+#else
+    if (auto p = std::aligned_alloc(a, n ? (n + a - 1) / a * a : a)) // a multiple of the alignment
+#endif
+        return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new[](std::size_t n, std::align_val_t al)
+{
+    return operator new(n, al);
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept
+{
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+[[gnu::noinline]] void operator delete[](void* p, std::align_val_t al) noexcept
+{
+    operator delete(p, al);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t, std::align_val_t al) noexcept
+{
+    operator delete(p, al);
+}
+
+[[gnu::noinline]] void operator delete[](void* p, std::size_t, std::align_val_t al) noexcept
+{
+    operator delete(p, al);
+}
+
+#endif
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include <common/input.h>
+
+namespace aoc
+{
+
+// a snapshot holds a day's built structures as arrays of plain values, so
+// that loading maps the file and uses the arrays where they lie. the layout
+// is a header, a table of sections (offset and size in bytes) and the
+// sections themselves, each 8 byte aligned. the header carries the format
+// version, the day's own kind and layout version and a checksum of all that
+// follows it. values are in the writing machine's byte order.
+//
+constexpr char          snapshot_magic[8] = { 'A', 'O', 'C', 'S', 'N', 'A', 'P', '\0' };
+constexpr std::uint32_t snapshot_format {1};
+
+struct snapshot_header
+{
+    char          magic_[8];
+    std::uint32_t format_;
+    std::uint32_t kind_;     // which day
+    std::uint32_t version_;  // of the day's layout
+    std::uint32_t sections_;
+    std::uint64_t size_;     // of the whole file
+    std::uint64_t checksum_; // of everything after the header
+};
+
+struct snapshot_section
+{
+    std::uint64_t offset_;
+    std::uint64_t bytes_;
+};
+
+// FNV-1a over 8 byte words, the tail zero padded. sections are 8 byte
+// aligned so all but the end of the file is whole words.
+//
+inline std::uint64_t snapshot_checksum(char const* p, size_t n)
+{
+    std::uint64_t h = 0xcbf29ce484222325;
+    for(; n >= 8; p += 8, n -= 8)
+    {
+        std::uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ w) * 0x100000001b3;
+    }
+    if( n)
+    {
+        std::uint64_t w {0};
+        std::memcpy(&w, p, n);
+        h = (h ^ w) * 0x100000001b3;
+    }
+    return h;
+}
+
+class snapshot_writer
+{
+    std::uint32_t                  kind_;
+    std::uint32_t                  version_;
+    std::vector<std::vector<char>> sections_;
+public:
+    snapshot_writer(std::uint32_t kind, std::uint32_t version) : kind_{kind}, version_{version}
+    {}
+    template<typename T> void add(std::span<const T> s)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto p = reinterpret_cast<char const*>(s.data());
+        sections_.emplace_back(p, p + s.size_bytes());
+    }
+    template<typename T> void add(std::vector<T> const& v)
+    {
+        add(std::span<const T>(v));
+    }
+    void save(char const* path) const
+    {
+        auto align = [](std::uint64_t n) { return (n + 7) & ~std::uint64_t{7}; };
+        std::vector<char> body;
+        std::vector<snapshot_section> table(sections_.size());
+        std::uint64_t at = align(sizeof(snapshot_header) + table.size() * sizeof(snapshot_section));
+        for(size_t n = 0; n < sections_.size(); ++n)
+        {
+            table[n] = { at, sections_[n].size() };
+            at = align(at + sections_[n].size());
+        }
+        body.resize(at - sizeof(snapshot_header));
+        std::memcpy(body.data(), table.data(), table.size() * sizeof(snapshot_section));
+        for(size_t n = 0; n < sections_.size(); ++n)
+            if( !sections_[n].empty())
+                std::memcpy(body.data() + table[n].offset_ - sizeof(snapshot_header), sections_[n].data(), sections_[n].size());
+        snapshot_header h {};
+        std::memcpy(h.magic_, snapshot_magic, sizeof(h.magic_));
+        h.format_   = snapshot_format;
+        h.kind_     = kind_;
+        h.version_  = version_;
+        h.sections_ = std::uint32_t(sections_.size());
+        h.size_     = at;
+        h.checksum_ = snapshot_checksum(body.data(), body.size());
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<char const*>(&h), sizeof(h));
+        out.write(body.data(), body.size());
+        if( !out)
+            throw std::runtime_error(std::string("cannot write snapshot ") + path);
+    }
+};
+
+// a snapshot mapped (through aoc::input) and checked, its sections handed out
+// as spans into the mapping.
+//
+class snapshot
+{
+    input                   in_;
+    snapshot_header const*  h_ {nullptr};
+    snapshot_section const* table_ {nullptr};
+public:
+    snapshot(char const* path, std::uint32_t kind, std::uint32_t version) : in_{path}
+    {
+        auto txt = in_.text();
+        auto bad = [&](char const* why) { return std::runtime_error(std::string("snapshot ") + path + ' ' + why); };
+        if( txt.size() < sizeof(snapshot_header))
+            throw bad("is too short");
+        h_ = reinterpret_cast<snapshot_header const*>(txt.data());
+        if( std::memcmp(h_->magic_, snapshot_magic, sizeof(h_->magic_)) != 0)
+            throw bad("is not a snapshot");
+        if( h_->format_ != snapshot_format || h_->kind_ != kind || h_->version_ != version)
+            throw bad("is of another format, day or version");
+        if( h_->size_ != txt.size() || txt.size() < sizeof(snapshot_header) + h_->sections_ * sizeof(snapshot_section))
+            throw bad("is truncated");
+        if( snapshot_checksum(txt.data() + sizeof(snapshot_header), txt.size() - sizeof(snapshot_header)) != h_->checksum_)
+            throw bad("fails its checksum");
+        table_ = reinterpret_cast<snapshot_section const*>(txt.data() + sizeof(snapshot_header));
+        for(std::uint32_t n = 0; n < h_->sections_; ++n)
+            if( table_[n].offset_ % 8 || table_[n].offset_ + table_[n].bytes_ > txt.size())
+                throw bad("has a bad section");
+    }
+    size_t sections() const
+    {
+        return h_->sections_;
+    }
+    template<typename T> std::span<const T> section(size_t n) const
+    {
+        static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= 8);
+        if( n >= sections() || table_[n].bytes_ % sizeof(T))
+            throw std::runtime_error("snapshot section " + std::to_string(n) + " missing or of the wrong type");
+        return { reinterpret_cast<T const*>(in_.text().data() + table_[n].offset_), table_[n].bytes_ / sizeof(T) };
+    }
+};
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aoc
+{
+
+// a work stealing pool. each worker has its own deque, taking the newest
+// task from its back, and when that is empty steals the oldest from the
+// front of another's. tasks submitted from a worker go on its own deque, so
+// work a task spawns stays on the thread that has its data warm until
+// someone idle takes it. tasks are coarse (a puzzle part) so each deque is
+// simply locked.
+//
+class thread_pool
+{
+    struct queue
+    {
+        std::mutex                        m_;
+        std::deque<std::function<void()>> q_;
+    };
+    std::vector<std::unique_ptr<queue>> queues_;
+    std::atomic<size_t>                 queued_ { 0 };  // sitting in a deque
+    std::atomic<size_t>                 pending_ { 0 }; // submitted and not yet finished
+    std::atomic<size_t>                 next_ { 0 };    // for submissions from outside
+    std::mutex                          m_;
+    std::condition_variable             work_;
+    std::condition_variable             done_;
+    bool                                stop_ { false };
+    std::vector<std::jthread>           workers_;
+
+    static inline thread_local thread_pool* owner_ { nullptr };
+    static inline thread_local size_t       self_ { 0 };
+
+    bool take(size_t id, std::function<void()>& f)
+    {
+        {
+            auto& mine = *queues_[id];
+            std::lock_guard l(mine.m_);
+            if (!mine.q_.empty())
+            {
+                f = std::move(mine.q_.back());
+                mine.q_.pop_back();
+                return true;
+            }
+        }
+        for (size_t n = 1; n < queues_.size(); ++n)
+        {
+            auto& other = *queues_[(id + n) % queues_.size()];
+            std::lock_guard l(other.m_);
+            if (!other.q_.empty())
+            {
+                f = std::move(other.q_.front());
+                other.q_.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+    void work(size_t id)
+    {
+        owner_ = this;
+        self_  = id;
+        std::function<void()> f;
+        while (true)
+        {
+            if (take(id, f))
+            {
+                --queued_;
+                f();
+                f = nullptr;
+                if (--pending_ == 0)
+                {
+                    std::lock_guard l(m_);
+                    done_.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock l(m_);
+            work_.wait(l, [&]{ return stop_ || queued_ > 0;});
+            if (stop_ && queued_ == 0)
+                return;
+        }
+    }
+public:
+    explicit thread_pool(unsigned threads = std::thread::hardware_concurrency())
+    {
+        threads = std::max(threads, 1u);
+        for (unsigned n = 0; n < threads; ++n)
+            queues_.push_back(std::make_unique<queue>());
+        for (unsigned n = 0; n < threads; ++n)
+            workers_.emplace_back([this, n]{ work(n);});
+    }
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+    ~thread_pool()
+    {
+        wait();
+        {
+            std::lock_guard l(m_);
+            stop_ = true;
+        }
+        work_.notify_all();
+    }
+    size_t size() const
+    {
+        return workers_.size();
+    }
+    void submit(std::function<void()> f)
+    {
+        ++pending_;
+        {
+            // counted before it's pushed, so it can't be taken uncounted.
+            std::lock_guard l(m_);
+            ++queued_;
+        }
+        auto id = owner_ == this ? self_ : next_++ % queues_.size();
+        {
+            auto& q = *queues_[id];
+            std::lock_guard l(q.m_);
+            q.q_.push_back(std::move(f));
+        }
+        work_.notify_one();
+    }
+    // until every task, including those submitted by tasks, has finished.
+    //
+    void wait()
+    {
+        std::unique_lock l(m_);
+        done_.wait(l, [&]{ return pending_ == 0;});
+    }
+};
+
+}
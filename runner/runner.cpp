@@ -0,0 +1,154 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <exception>
+
+#include <common/input.h>
+#include <common/thread_pool.h>
+#include <common/instrument_alloc.h>
+
+#include "runner.h"
+
+using clock_type = std::chrono::steady_clock;
+
+double ms(clock_type::time_point from, clock_type::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+struct part_result
+{
+    std::string name_;
+    std::string answer_;
+    double      ms_ { 0 };
+};
+
+// a line of the manifest. a job is loaded as one task, then each of its parts
+// is a task of its own, the last to finish marking the job's end.
+//
+struct job
+{
+    aoc::runner::day const*  day_;
+    std::string              fn_;
+    std::string              error_;
+    double                   load_ms_ { 0 };
+    std::vector<part_result> parts_;
+    std::atomic<size_t>      left_ { 0 };
+    clock_type::time_point   start_;
+    clock_type::time_point   end_;
+};
+
+void run(job& j, aoc::thread_pool& pool)
+{
+    j.start_ = clock_type::now();
+    std::vector<aoc::runner::part> parts;
+    try
+    {
+        parts = j.day_->load_(j.fn_.empty() ? nullptr : j.fn_.c_str());
+    }
+    catch (std::exception const& e)
+    {
+        j.error_ = e.what();
+    }
+    j.end_     = clock_type::now();
+    j.load_ms_ = ms(j.start_, j.end_);
+    j.parts_.resize(parts.size());
+    j.left_ = parts.size();
+    for (size_t n = 0; n < parts.size(); ++n)
+        pool.submit([&j, n, p = std::move(parts[n])]
+            {
+                auto t0 = clock_type::now();
+                auto& r = j.parts_[n];
+                r.name_ = p.name_;
+                try
+                {
+                    r.answer_ = p.run_();
+                }
+                catch (std::exception const& e)
+                {
+                    r.answer_ = std::string("error : ") + e.what();
+                }
+                auto t1 = clock_type::now();
+                r.ms_ = ms(t0, t1);
+                if (--j.left_ == 0)
+                    j.end_ = t1;
+            });
+}
+
+// usage : aoc_runner [--threads N] [manifest file]
+//
+// each manifest line is a day and an input file for it, as
+//
+// 2019-06 inputs/2019_6.txt
+// 2018-22
+//
+// with 2018-22 falling back to its own puzzle input when given no file. lines
+// starting '#' are ignored. the jobs, and the parts within each, run on a
+// pool of N threads (all the hardware has by default), and the answers are
+// reported in manifest order with the time each job took and the total.
+//
+int main(int ac, char* av[])
+{
+    unsigned threads { std::max(std::thread::hardware_concurrency(), 1u) };
+    char const* fn { nullptr };
+    for (int n = 1; n < ac; ++n)
+    {
+        std::string_view arg { av[n] };
+        if (arg == "--threads" && n + 1 < ac)
+            threads = std::max(std::stoi(av[++n]), 1);
+        else
+            fn = av[n];
+    }
+    aoc::runner::day const days[] { aoc::runner::aoc2018_22(), aoc::runner::aoc2019_6(), aoc::runner::aoc2019_20(), aoc::runner::aoc2020_7() };
+
+    auto in = fn ? aoc::input(fn) : aoc::input();
+    std::vector<std::unique_ptr<job>> jobs;
+    for (auto ln : aoc::lines(in.text()))
+    {
+        if (ln.empty() || ln.front() == '#')
+            continue;
+        auto nm = aoc::next_field(ln, ' ');
+        auto d  = std::find_if(std::begin(days), std::end(days), [&](auto& d){ return nm == d.name_;});
+        if (d == std::end(days))
+        {
+            std::cout << "Unknown day \"" << nm << "\".\n";
+            continue;
+        }
+        auto j = std::make_unique<job>();
+        j->day_ = &*d;
+        j->fn_  = std::string(ln.substr(0, ln.find_last_not_of(' ') + 1));
+        jobs.push_back(std::move(j));
+    }
+
+    auto t0 = clock_type::now();
+    {
+        aoc::thread_pool pool(threads);
+        for (auto& j : jobs)
+            pool.submit([&j = *j, &pool]{ run(j, pool);});
+        pool.wait();
+    }
+    auto t1 = clock_type::now();
+
+    double busy { 0 };
+    for (auto& j : jobs)
+    {
+        std::cout << j->day_->name_ << ' ' << (j->fn_.empty() ? "(puzzle input)" : j->fn_) << '\n';
+        if (!j->error_.empty())
+            std::cout << "  error : " << j->error_ << '\n';
+        std::cout << "  load " << j->load_ms_ << "ms\n";
+        busy += j->load_ms_;
+        for (auto& p : j->parts_)
+        {
+            std::cout << "  " << p.name_ << " = " << p.answer_ << " (" << p.ms_ << "ms)\n";
+            busy += p.ms_;
+        }
+        std::cout << "  wall " << ms(j->start_, j->end_) << "ms\n";
+    }
+    std::cout << jobs.size() << " jobs on " << threads << " threads, wall " << ms(t0, t1) << "ms, " << busy << "ms of work\n";
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <common/input.h>
+
+namespace aoc::runner
+{
+
+// a part of a day, returning its answer as text. the parts of one input
+// share what was loaded for them and may run at once.
+//
+struct part
+{
+    std::string                  name_;
+    std::function<std::string()> run_;
+};
+
+// load_ reads and parses an input, or the day's own puzzle input given
+// nullptr, and hands back the parts to run on it.
+//
+struct day
+{
+    char const*                                     name_;
+    std::function<std::vector<part>(char const*)> load_;
+};
+
+// a day from what its parts share and the parts. load reads and parses an
+// input, given the aoc::input for the file if it takes one, and else the file
+// name or nullptr for the day's own puzzle input. pt1 and pt2 answer from what
+// load returned, which both share.
+//
+template<typename L, typename P1, typename P2> day make_day(char const* name, L load, P1 pt1, P2 pt2)
+{
+    return { name, [=](char const* fn)
+        {
+            auto loaded = [&]
+            {
+                if constexpr (std::is_invocable_v<L, aoc::input const&>)
+                {
+                    if (!fn)
+                        throw std::runtime_error(std::string(name) + " needs an input file");
+                    return load(aoc::input(fn));
+                }
+                else
+                    return load(fn);
+            };
+            auto in = std::make_shared<decltype(loaded())>(loaded());
+            std::vector<part> rv;
+            rv.push_back({ "pt1", [=]{ return pt1(*in);}});
+            rv.push_back({ "pt2", [=]{ return pt2(*in);}});
+            return rv;
+        }};
+}
+
+// every day is built into the runner from its own source. that source keeps
+// all but its main in a namespace named for the day, so the days link into
+// one program, and leaves main out when built with AOC_RUNNER, as it does
+// with AOC_BENCH for a benchmark including it. in its place it defines the
+// day's entry with AOC_RUNNER_ENTRY(ns, name, load, pt1, pt2), after the
+// namespace closes. load, pt1 and pt2 are as for make_day, and see the day's
+// names unqualified. they're taken as '...' so that a comma within a lambda
+// doesn't split it.
+//
+#define AOC_RUNNER_ENTRY(ns, name, ...)         \
+    aoc::runner::day aoc::runner::ns()          \
+    {                                           \
+        using namespace ::ns;                   \
+        return make_day(name, __VA_ARGS__);     \
+    }
+
+day aoc2018_22();
+day aoc2019_6();
+day aoc2019_20();
+day aoc2020_7();
+
+}